@@ -0,0 +1,114 @@
+#include "alert_bridge.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+AlertBridge::AlertBridge()
+    : active_(false)
+    , declared_(false)
+    , started_ns_(0)
+    , alerts_(0)
+    , last_latency_ms_(0.0)
+    , avg_latency_ms_(0.0)
+    , latency_samples_(0) {
+}
+
+void AlertBridge::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Latency figures describe the bridge, not the page, and are kept
+    active_ = false;
+    declared_ = false;
+    started_ns_ = 0;
+    alerts_ = 0;
+}
+
+bool AlertBridge::HandleMessage(const std::string& payload, uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (payload == "declare") {
+        declared_ = true;
+        return false;
+    }
+    
+    bool start = payload.compare(0, 6, "start:") == 0;
+    bool end = payload.compare(0, 4, "end:") == 0;
+    if (!start && !end) {
+        return false;
+    }
+    
+    // Both clocks are the wall clock of this machine
+    double page_ms = strtod(payload.c_str() + (start ? 6 : 4), nullptr);
+    double native_ms = (double)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (page_ms > 0.0 && native_ms >= page_ms) {
+        last_latency_ms_ = native_ms - page_ms;
+        latency_samples_++;
+        avg_latency_ms_ += (last_latency_ms_ - avg_latency_ms_) / (double)latency_samples_;
+    }
+    
+    if (end) {
+        active_ = false;
+        return false;
+    }
+    
+    bool started = !active_ || now_ns - started_ns_ > ALERT_MAX_ACTIVE_NS;
+    active_ = true;
+    started_ns_ = now_ns;
+    if (started) {
+        alerts_++;
+    }
+    return started;
+}
+
+bool AlertBridge::IsActive(uint64_t now_ns) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_ && now_ns - started_ns_ <= ALERT_MAX_ACTIVE_NS;
+}
+
+bool AlertBridge::IsDeclared() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return declared_;
+}
+
+AlertSnapshot AlertBridge::GetSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    AlertSnapshot snapshot;
+    snapshot.active = active_;
+    snapshot.declared = declared_;
+    snapshot.alerts = alerts_;
+    snapshot.last_latency_ms = last_latency_ms_;
+    snapshot.avg_latency_ms = avg_latency_ms_;
+    return snapshot;
+}
+
+std::string AlertBridge::GetShim() {
+    // Idempotent, so a re-injection after a same-document navigation is harmless
+    return std::string(
+        "(function() {"
+        "  var api = window.obsChromium = window.obsChromium || {};"
+        "  if (api.__bridge) { return; }"
+        "  api.__bridge = true;"
+        "  var prefix = '" ALERT_BRIDGE_PREFIX "';"
+        "  var active = 0;"
+        "  var declared = false;"
+        "  var send = function(kind) { console.log(prefix + kind + ':' + Date.now()); };"
+        "  var start = function() { if (active++ === 0) { send('start'); } };"
+        "  var end = function() { if (active > 0 && --active === 0) { send('end'); } };"
+        "  var declare = function() {"
+        "    if (!declared) { declared = true; console.log(prefix + 'declare'); }"
+        "  };"
+        "  api.alertStart = function() { declare(); start(); };"
+        "  api.alertEnd = function() { declare(); end(); };"
+        // Widgets that do not know the bridge: media playback is an alert
+        "  var playing = new Set();"
+        "  document.addEventListener('play', function(e) {"
+        "    if (!playing.has(e.target)) { playing.add(e.target); start(); }"
+        "  }, true);"
+        "  var stop = function(e) { if (playing.delete(e.target)) { end(); } };"
+        "  ['ended', 'pause', 'emptied'].forEach(function(type) {"
+        "    document.addEventListener(type, stop, true);"
+        "  });"
+        "})();");
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <obs-module.h>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+/**
+ * Point-in-time view of a page's alert activity for display.
+ */
+struct AlertSnapshot {
+    bool active;
+    bool declared;             // the page drives the bridge itself
+    uint32_t alerts;           // alerts started since the page loaded
+    double last_latency_ms;    // page timestamp to native receipt
+    double avg_latency_ms;
+};
+
+/**
+ * Tracks when a page is playing an alert. A shim injected when the page
+ * starts loading defines window.obsChromium.alertStart()/alertEnd() and also treats
+ * media playback as an alert for widgets that do not call it; both report
+ * through the console, like the health heartbeat. Pages that call the API
+ * themselves are rendered at the idle rate between alerts (on Program
+ * only if the source opts in), and any page is raised to the full rate
+ * while an alert plays.
+ */
+class AlertBridge {
+public:
+    AlertBridge();
+    
+    /**
+     * Forget the page's state, e.g. when a new page starts loading.
+     */
+    void Reset();
+    
+    /**
+     * Handle a console message carrying ALERT_BRIDGE_PREFIX. Called on the
+     * CEF UI thread.
+     * @return true if an alert has just started
+     */
+    bool HandleMessage(const std::string& payload, uint64_t now_ns);
+    
+    /**
+     * Check whether an alert is playing. An alert that never reported
+     * its end stops counting after ALERT_MAX_ACTIVE_NS.
+     */
+    bool IsActive(uint64_t now_ns) const;
+    
+    /**
+     * Check whether the page calls the bridge API itself, so its quiet
+     * periods can be trusted.
+     */
+    bool IsDeclared() const;
+    
+    /**
+     * Get the current state and latency figures.
+     */
+    AlertSnapshot GetSnapshot() const;
+    
+    /**
+     * Script injected into every main frame when it starts loading, and
+     * again once it has loaded.
+     */
+    static std::string GetShim();
+    
+private:
+    mutable std::mutex mutex_;
+    bool active_;
+    bool declared_;
+    uint64_t started_ns_;
+    uint32_t alerts_;
+    double last_latency_ms_;
+    double avg_latency_ms_;
+    uint32_t latency_samples_;
+};
+
+/**
+ * Bridge protocol: "<prefix>declare", "<prefix>start:<ms>" and
+ * "<prefix>end:<ms>", with the page's Date.now() at the time of the call.
+ */
+#define ALERT_BRIDGE_PREFIX "__obs_chromium_alert__:"
+
+/**
+ * Longest an alert counts as playing without an end message.
+ */
+#define ALERT_MAX_ACTIVE_NS 60000000000ULL   // 1 minute
@@ -0,0 +1,1030 @@
+#include "asset_cache.h"
+#include "asset_prefetch.h"
+#include "plugin.h"
+#include <include/cef_resource_handler.h>
+#include <include/cef_response_filter.h>
+#include <include/cef_urlrequest.h>
+#include <include/cef_task.h>
+#include <include/base/cef_callback.h>
+#include <include/wrapper/cef_closure_task.h>
+#include <obs-module.h>
+#include <util/platform.h>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <set>
+
+namespace {
+
+uint64_t Fnv1a(const std::string& text) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    return text;
+}
+
+std::string Trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last + 1 - first);
+}
+
+/**
+ * Expiry from Cache-Control. Without max-age an asset is stale at once and
+ * only saves the download when its validators confirm it.
+ */
+int64_t GetExpires(CefRefPtr<CefResponse> response, int64_t now, bool& no_store) {
+    std::string cache_control = ToLower(response->GetHeaderByName("Cache-Control").ToString());
+    no_store = cache_control.find("no-store") != std::string::npos;
+    if (cache_control.find("no-cache") != std::string::npos) {
+        return now;
+    }
+    
+    size_t max_age = cache_control.find("max-age=");
+    if (max_age == std::string::npos) {
+        return now;
+    }
+    return now + strtoll(cache_control.c_str() + max_age + 8, nullptr, 10);
+}
+
+/**
+ * Key a body by the request headers its response varies on, as
+ * "name:value" lines in the order Vary lists them. Accept-Encoding is left
+ * out; bodies are stored decoded.
+ * @return false for "Vary: *", which no stored copy can satisfy
+ */
+bool GetVaryKey(const std::string& vary, CefRefPtr<CefRequest> request, std::string& key) {
+    key.clear();
+    std::string names = ToLower(vary);
+    size_t begin = 0;
+    while (begin < names.size()) {
+        size_t end = std::min(names.find(',', begin), names.size());
+        std::string name = Trim(names.substr(begin, end - begin));
+        begin = end + 1;
+        
+        if (name == "*") {
+            return false;
+        }
+        if (name.empty() || name == "accept-encoding") {
+            continue;
+        }
+        std::string value = request ? request->GetHeaderByName(name).ToString() : std::string();
+        key += name + ":" + value + "\n";
+    }
+    return true;
+}
+
+/**
+ * Header names of a vary key, in the form GetVaryKey takes them.
+ */
+std::string GetVaryNames(const std::string& key) {
+    std::string names;
+    size_t begin = 0;
+    while (begin < key.size()) {
+        size_t colon = key.find(':', begin);
+        size_t end = key.find('\n', begin);
+        if (colon == std::string::npos || end == std::string::npos) {
+            break;
+        }
+        names += (names.empty() ? "" : ",") + key.substr(begin, colon - begin);
+        begin = end + 1;
+    }
+    return names;
+}
+
+/**
+ * Parse a single "bytes=" range into [begin, end). Anything else, including
+ * multiple ranges, is answered with the whole body.
+ */
+bool ParseRange(const std::string& header, size_t size, size_t& begin, size_t& end) {
+    if (header.compare(0, 6, "bytes=") != 0 || header.find(',') != std::string::npos || !size) {
+        return false;
+    }
+    
+    const char* spec = header.c_str() + 6;
+    if (*spec == '-') {
+        unsigned long long suffix = strtoull(spec + 1, nullptr, 10);
+        if (!suffix) {
+            return false;
+        }
+        begin = size - (size_t)std::min<unsigned long long>(suffix, size);
+        end = size;
+        return true;
+    }
+    
+    char* dash = nullptr;
+    unsigned long long first = strtoull(spec, &dash, 10);
+    if (!dash || *dash != '-' || first >= size) {
+        return false;
+    }
+    unsigned long long last = dash[1] ? strtoull(dash + 1, nullptr, 10) : size - 1;
+    if (last < first) {
+        return false;
+    }
+    begin = (size_t)first;
+    end = (size_t)std::min<unsigned long long>(last + 1, size);
+    return true;
+}
+
+std::shared_ptr<AssetMapping> MapFile(const std::string& path, uint64_t size) {
+    auto mapping = std::make_shared<AssetMapping>();
+    mapping->file.reset(new QFile(QString::fromUtf8(path.c_str())));
+    if (!mapping->file->open(QIODevice::ReadOnly) || (uint64_t)mapping->file->size() != size) {
+        return nullptr;
+    }
+    
+    uchar* data = mapping->file->map(0, (qint64)size);
+    if (!data) {
+        return nullptr;
+    }
+    mapping->data = data;
+    mapping->size = (size_t)size;
+    return mapping;
+}
+
+/**
+ * Serves a stored asset from its mapping, honouring a byte range so media
+ * elements can seek.
+ */
+class AssetResourceHandler : public CefResourceHandler {
+public:
+    explicit AssetResourceHandler(const AssetHit& hit)
+        : hit_(hit)
+        , begin_(0)
+        , end_(hit.mapping->size)
+        , offset_(0)
+        , partial_(false) {
+    }
+    
+    ~AssetResourceHandler() override {
+        AssetCache::GetInstance()->RecordServed(offset_ - begin_);
+    }
+    
+    bool Open(CefRefPtr<CefRequest> request, bool& handle_request,
+              CefRefPtr<CefCallback> callback) override {
+        // Everything is in memory already, so answer synchronously
+        partial_ = ParseRange(request->GetHeaderByName("Range").ToString(),
+                              hit_.mapping->size, begin_, end_);
+        offset_ = begin_;
+        handle_request = true;
+        return true;
+    }
+    
+    void GetResponseHeaders(CefRefPtr<CefResponse> response, int64_t& response_length,
+                            CefString& redirect_url) override {
+        CefResponse::HeaderMap headers;
+        headers.insert(std::make_pair("Accept-Ranges", "bytes"));
+        if (!hit_.etag.empty()) {
+            headers.insert(std::make_pair("ETag", hit_.etag));
+        }
+        if (!hit_.last_modified.empty()) {
+            headers.insert(std::make_pair("Last-Modified", hit_.last_modified));
+        }
+        if (!hit_.allow_origin.empty()) {
+            headers.insert(std::make_pair("Access-Control-Allow-Origin", hit_.allow_origin));
+        }
+        if (partial_) {
+            char range[96];
+            snprintf(range, sizeof(range), "bytes %zu-%zu/%zu", begin_, end_ - 1, hit_.mapping->size);
+            headers.insert(std::make_pair("Content-Range", range));
+        }
+        
+        response->SetStatus(partial_ ? 206 : 200);
+        response->SetStatusText(partial_ ? "Partial Content" : "OK");
+        response->SetMimeType(hit_.content_type);
+        response->SetHeaderMap(headers);
+        response_length = (int64_t)(end_ - begin_);
+    }
+    
+    bool Skip(int64_t bytes_to_skip, int64_t& bytes_skipped,
+              CefRefPtr<CefResourceSkipCallback> callback) override {
+        size_t skip = std::min((size_t)std::max<int64_t>(bytes_to_skip, 0), end_ - offset_);
+        offset_ += skip;
+        bytes_skipped = (int64_t)skip;
+        return true;
+    }
+    
+    bool Read(void* data_out, int bytes_to_read, int& bytes_read,
+              CefRefPtr<CefResourceReadCallback> callback) override {
+        size_t read = std::min((size_t)std::max(bytes_to_read, 0), end_ - offset_);
+        bytes_read = (int)read;
+        if (!read) {
+            return false;   // response complete
+        }
+        
+        // The only copy: from the page cache into Chromium's buffer
+        memcpy(data_out, hit_.mapping->data + offset_, read);
+        offset_ += read;
+        return true;
+    }
+    
+    void Cancel() override {
+    }
+    
+private:
+    AssetHit hit_;
+    size_t begin_;
+    size_t end_;
+    size_t offset_;
+    bool partial_;
+    
+    IMPLEMENT_REFCOUNTING(AssetResourceHandler);
+};
+
+/**
+ * Passes a network response through unchanged while keeping a copy of it.
+ */
+class AssetCaptureFilter : public CefResponseFilter {
+public:
+    explicit AssetCaptureFilter(size_t max_bytes)
+        : max_bytes_(max_bytes)
+        , overflow_(false) {
+    }
+    
+    bool InitFilter() override {
+        return true;
+    }
+    
+    FilterStatus Filter(void* data_in, size_t data_in_size, size_t& data_in_read,
+                        void* data_out, size_t data_out_size, size_t& data_out_written) override {
+        size_t size = std::min(data_in_size, data_out_size);
+        if (size) {
+            memcpy(data_out, data_in, size);
+        }
+        data_in_read = size;
+        data_out_written = size;
+        
+        if (!overflow_ && size) {
+            if (body_.size() + size > max_bytes_) {
+                overflow_ = true;
+                std::vector<uint8_t>().swap(body_);
+            } else {
+                const uint8_t* in = static_cast<const uint8_t*>(data_in);
+                body_.insert(body_.end(), in, in + size);
+            }
+        }
+        return RESPONSE_FILTER_NEED_MORE_DATA;
+    }
+    
+    bool IsComplete() const {
+        return !overflow_ && !body_.empty();
+    }
+    
+    std::vector<uint8_t> TakeBody() {
+        return std::move(body_);
+    }
+    
+private:
+    size_t max_bytes_;
+    bool overflow_;
+    std::vector<uint8_t> body_;
+    
+    IMPLEMENT_REFCOUNTING(AssetCaptureFilter);
+};
+
+/**
+ * Conditional request for a stale asset, made outside any page.
+ */
+class AssetRevalidateClient : public CefURLRequestClient {
+public:
+    AssetRevalidateClient(const std::string& url, size_t max_bytes)
+        : url_(url)
+        , max_bytes_(max_bytes)
+        , overflow_(false) {
+    }
+    
+    void Start(CefRefPtr<CefRequest> request, CefRefPtr<CefRequestContext> context) {
+        // Holds the request until it completes; released in OnRequestComplete
+        request_ = CefURLRequest::Create(request, this, context);
+        if (!request_) {
+            AssetCache::GetInstance()->EndRevalidate(url_);
+        }
+    }
+    
+    void OnRequestComplete(CefRefPtr<CefURLRequest> request) override {
+        AssetCache* cache = AssetCache::GetInstance();
+        CefRefPtr<CefResponse> response = request->GetResponse();
+        
+        if (request->GetRequestStatus() == UR_SUCCESS && response) {
+            if (response->GetStatus() == 304) {
+                bool no_store = false;
+                cache->Refresh(url_, GetExpires(response, (int64_t)time(nullptr), no_store));
+            } else if (!overflow_ && !body_.empty()) {
+                // Changed upstream: store the new version under its new validators
+                auto asset = std::make_shared<PendingAsset>();
+                if (cache->Accept(url_, request->GetRequest(), response, *asset)) {
+                    asset->body = std::move(body_);
+                    cache->Store(asset);
+                }
+            }
+        }
+        
+        cache->EndRevalidate(url_);
+        request_ = nullptr;
+    }
+    
+    void OnUploadProgress(CefRefPtr<CefURLRequest> request, int64_t current, int64_t total) override {
+    }
+    
+    void OnDownloadProgress(CefRefPtr<CefURLRequest> request, int64_t current, int64_t total) override {
+    }
+    
+    void OnDownloadData(CefRefPtr<CefURLRequest> request, const void* data, size_t data_length) override {
+        if (overflow_) {
+            return;
+        }
+        if (body_.size() + data_length > max_bytes_) {
+            overflow_ = true;
+            std::vector<uint8_t>().swap(body_);
+            return;
+        }
+        const uint8_t* in = static_cast<const uint8_t*>(data);
+        body_.insert(body_.end(), in, in + data_length);
+    }
+    
+private:
+    std::string url_;
+    size_t max_bytes_;
+    bool overflow_;
+    std::vector<uint8_t> body_;
+    CefRefPtr<CefURLRequest> request_;
+    
+    IMPLEMENT_REFCOUNTING(AssetRevalidateClient);
+};
+
+/**
+ * Per-request layer: serves hits, and captures misses on their way to the
+ * page.
+ */
+class AssetRequestHandler : public CefResourceRequestHandler {
+public:
+    explicit AssetRequestHandler(const std::string& page_url)
+        : page_url_(page_url)
+        , served_(false) {
+    }
+    
+    CefRefPtr<CefResourceHandler> GetResourceHandler(CefRefPtr<CefBrowser> browser,
+                                                     CefRefPtr<CefFrame> frame,
+                                                     CefRefPtr<CefRequest> request) override {
+        AssetCache* cache = AssetCache::GetInstance();
+        AssetHit hit;
+        if (!cache->Lookup(request->GetURL().ToString(), request, hit)) {
+            return nullptr;
+        }
+        
+        if (hit.revalidate) {
+            if (browser) {
+                cache->Revalidate(browser->GetHost()->GetRequestContext(), hit);
+            } else {
+                cache->EndRevalidate(hit.url);
+            }
+        }
+        served_ = true;
+        AssetPrefetcher::GetInstance()->RecordFetch(page_url_, hit.url);
+        return new AssetResourceHandler(hit);
+    }
+    
+    CefRefPtr<CefResponseFilter> GetResourceResponseFilter(CefRefPtr<CefBrowser> browser,
+                                                           CefRefPtr<CefFrame> frame,
+                                                           CefRefPtr<CefRequest> request,
+                                                           CefRefPtr<CefResponse> response) override {
+        if (served_) {
+            return nullptr;
+        }
+        
+        AssetCache* cache = AssetCache::GetInstance();
+        auto asset = std::make_shared<PendingAsset>();
+        if (!cache->Accept(request->GetURL().ToString(), request, response, *asset)) {
+            return nullptr;
+        }
+        pending_ = asset;
+        filter_ = new AssetCaptureFilter(cache->GetMaxEntryBytes());
+        return filter_;
+    }
+    
+    void OnResourceLoadComplete(CefRefPtr<CefBrowser> browser,
+                                CefRefPtr<CefFrame> frame,
+                                CefRefPtr<CefRequest> request,
+                                CefRefPtr<CefResponse> response,
+                                URLRequestStatus status,
+                                int64_t received_content_length) override {
+        if (!filter_ || status != UR_SUCCESS || !filter_->IsComplete()) {
+            return;
+        }
+        pending_->body = filter_->TakeBody();
+        AssetPrefetcher::GetInstance()->RecordFetch(page_url_, pending_->url);
+        AssetCache::GetInstance()->Store(pending_);
+        pending_.reset();
+        filter_ = nullptr;
+    }
+    
+private:
+    std::string page_url_;
+    bool served_;
+    CefRefPtr<AssetCaptureFilter> filter_;
+    std::shared_ptr<PendingAsset> pending_;
+    
+    IMPLEMENT_REFCOUNTING(AssetRequestHandler);
+};
+
+} // namespace
+
+AssetMapping::AssetMapping()
+    : data(nullptr)
+    , size(0) {
+}
+
+AssetMapping::~AssetMapping() {
+    if (file && data) {
+        file->unmap(const_cast<uchar*>(data));
+    }
+}
+
+AssetCache* AssetCache::GetInstance() {
+    static AssetCache instance;
+    return &instance;
+}
+
+AssetCache::AssetCache()
+    : limit_bytes_(0)
+    , stored_bytes_(0)
+    , enabled_(false)
+    , pinned_(false)
+    , hits_(0)
+    , misses_(0)
+    , revalidations_(0)
+    , stored_(0)
+    , bytes_saved_(0) {
+}
+
+void AssetCache::Open() {
+    obs_data_t* config = ChromiumPlugin::GetInstance()->GetConfig();
+    long long size_mb = config ? obs_data_get_int(config, CONFIG_ASSET_CACHE_SIZE) : 0;
+    if (size_mb <= 0) {
+        blog(LOG_INFO, "[Asset Cache] Disabled");
+        return;
+    }
+    
+    char* directory = obs_module_config_path(ASSET_CACHE_DIR);
+    if (!directory || os_mkdirs(directory) == MKDIR_ERROR) {
+        blog(LOG_WARNING, "[Asset Cache] Could not create the cache directory, cache disabled");
+        bfree(directory);
+        return;
+    }
+    directory_ = directory;
+    bfree(directory);
+    
+    limit_bytes_ = (uint64_t)size_mb * 1024 * 1024;
+    pinned_ = obs_data_get_bool(config, CONFIG_ASSET_CACHE_PINNED);
+    LoadIndex();
+    enabled_ = true;
+    
+    blog(LOG_INFO, "[Asset Cache] %zu assets (%.1f MB of %lld MB)%s", entries_.size(),
+         stored_bytes_ / (1024.0 * 1024.0), size_mb, pinned_ ? ", pinned" : "");
+}
+
+void AssetCache::Close() {
+    if (!enabled_) {
+        return;
+    }
+    
+    enabled_ = false;
+    SaveIndex();
+    LogStats();
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    stored_bytes_ = 0;
+}
+
+CefRefPtr<CefResourceRequestHandler> AssetCache::GetRequestHandler(CefRefPtr<CefRequest> request,
+                                                                   const std::string& page_url) {
+    if (!enabled_ || !IsMedia(request)) {
+        return nullptr;
+    }
+    return new AssetRequestHandler(page_url);
+}
+
+bool AssetCache::IsEnabled() const {
+    return enabled_;
+}
+
+bool AssetCache::IsStored(const std::string& url) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.find(url) != entries_.end();
+}
+
+void AssetCache::Warm(const std::string& url) {
+    if (!enabled_) {
+        return;
+    }
+    CefPostTask(TID_FILE_USER_VISIBLE, base::BindOnce(&AssetCache::Touch, base::Unretained(this), url));
+}
+
+bool AssetCache::Lookup(const std::string& url, CefRefPtr<CefRequest> request, AssetHit& hit) {
+    std::string file;
+    uint64_t size = 0;
+    std::shared_ptr<AssetMapping> mapping;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        auto it = entries_.find(url);
+        if (it == entries_.end()) {
+            misses_++;
+            return false;
+        }
+        
+        const Entry& entry = it->second;
+        bool stale = !pinned_ && (int64_t)time(nullptr) >= entry.expires;
+        if (stale && entry.etag.empty() && entry.last_modified.empty()) {
+            // Nothing to revalidate with; the download replaces it
+            misses_++;
+            return false;
+        }
+        
+        // Stored for another variant or another origin; the download
+        // replaces it
+        if (!Matches(entry, request)) {
+            misses_++;
+            return false;
+        }
+        
+        file = entry.file;
+        size = entry.size;
+        mapping = entry.mapping;
+    }
+    
+    // Opening and mapping wait for the disk; other requests must not
+    if (!mapping) {
+        mapping = MapFile(GetPath(file), size);
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = entries_.find(url);
+    if (it == entries_.end() || it->second.file != file) {
+        // Replaced or evicted meanwhile
+        misses_++;
+        return false;
+    }
+    
+    Entry& entry = it->second;
+    if (!mapping) {
+        blog(LOG_WARNING, "[Asset Cache] Dropping unreadable asset %s", entry.file.c_str());
+        RemoveLocked(it);
+        misses_++;
+        return false;
+    }
+    if (!entry.mapping) {
+        entry.mapping = mapping;
+    }
+    
+    int64_t now = (int64_t)time(nullptr);
+    bool stale = !pinned_ && now >= entry.expires;
+    entry.last_used = now;
+    hit.url = url;
+    hit.mapping = entry.mapping;
+    hit.content_type = entry.content_type;
+    hit.etag = entry.etag;
+    hit.last_modified = entry.last_modified;
+    hit.allow_origin = entry.allow_origin;
+    hit.origin = entry.origin;
+    hit.vary = entry.vary;
+    hit.revalidate = stale && !entry.revalidating;
+    if (hit.revalidate) {
+        entry.revalidating = true;
+    }
+    hits_++;
+    return true;
+}
+
+bool AssetCache::Accept(const std::string& url, CefRefPtr<CefRequest> request, CefRefPtr<CefResponse> response,
+                        PendingAsset& asset) const {
+    int status = response->GetStatus();
+    if (status == 206) {
+        // Media elements ask for "bytes=0-"; a range covering the whole body is the asset
+        unsigned long long first = 0, last = 0, total = 0;
+        std::string range = response->GetHeaderByName("Content-Range").ToString();
+        if (sscanf(range.c_str(), "bytes %llu-%llu/%llu", &first, &last, &total) != 3 ||
+            first != 0 || last + 1 != total) {
+            return false;
+        }
+    } else if (status != 200) {
+        return false;
+    }
+    
+    std::string length = response->GetHeaderByName("Content-Length").ToString();
+    if (!length.empty() && strtoull(length.c_str(), nullptr, 10) > GetMaxEntryBytes()) {
+        return false;
+    }
+    
+    bool no_store = false;
+    int64_t expires = GetExpires(response, (int64_t)time(nullptr), no_store);
+    if (no_store) {
+        return false;
+    }
+    
+    // The body is only reused for requests with the same varied headers
+    if (!GetVaryKey(response->GetHeaderByName("Vary").ToString(), request, asset.vary)) {
+        return false;
+    }
+    
+    asset.url = url;
+    asset.content_type = response->GetMimeType().ToString();
+    asset.etag = response->GetHeaderByName("ETag").ToString();
+    asset.last_modified = response->GetHeaderByName("Last-Modified").ToString();
+    asset.allow_origin = response->GetHeaderByName("Access-Control-Allow-Origin").ToString();
+    asset.origin = request ? request->GetHeaderByName("Origin").ToString() : std::string();
+    asset.expires = expires;
+    return true;
+}
+
+void AssetCache::Store(std::shared_ptr<PendingAsset> asset) {
+    if (!enabled_ || !asset || asset->body.empty()) {
+        return;
+    }
+    
+    // Disk writes stay off the IO thread
+    CefPostTask(TID_FILE_USER_VISIBLE, base::BindOnce(&AssetCache::Write, base::Unretained(this), asset));
+}
+
+void AssetCache::Revalidate(CefRefPtr<CefRequestContext> context, const AssetHit& hit) {
+    CefRequest::HeaderMap headers;
+    if (!hit.etag.empty()) {
+        headers.insert(std::make_pair("If-None-Match", hit.etag));
+    }
+    if (!hit.last_modified.empty()) {
+        headers.insert(std::make_pair("If-Modified-Since", hit.last_modified));
+    }
+    
+    // Ask for the same variant, with the CORS headers the page got
+    if (!hit.origin.empty()) {
+        headers.insert(std::make_pair("Origin", hit.origin));
+    }
+    size_t begin = 0;
+    while (begin < hit.vary.size()) {
+        size_t colon = hit.vary.find(':', begin);
+        size_t end = hit.vary.find('\n', begin);
+        if (colon == std::string::npos || end == std::string::npos) {
+            break;
+        }
+        std::string name = hit.vary.substr(begin, colon - begin);
+        std::string value = hit.vary.substr(colon + 1, end - colon - 1);
+        if (name != "origin" && !value.empty()) {
+            headers.insert(std::make_pair(name, value));
+        }
+        begin = end + 1;
+    }
+    
+    CefRefPtr<CefRequest> request = CefRequest::Create();
+    request->Set(hit.url, "GET", nullptr, headers);
+    // Chromium's HTTP cache would otherwise answer in the server's place
+    request->SetFlags(UR_FLAG_SKIP_CACHE);
+    
+    revalidations_++;
+    CefRefPtr<AssetRevalidateClient> client = new AssetRevalidateClient(hit.url, GetMaxEntryBytes());
+    client->Start(request, context);
+}
+
+void AssetCache::Refresh(const std::string& url, int64_t expires) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(url);
+    if (it != entries_.end()) {
+        it->second.expires = std::max(it->second.expires, expires);
+    }
+}
+
+void AssetCache::EndRevalidate(const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(url);
+    if (it != entries_.end()) {
+        it->second.revalidating = false;
+    }
+}
+
+void AssetCache::RecordServed(uint64_t bytes) {
+    bytes_saved_ += bytes;
+}
+
+size_t AssetCache::GetMaxEntryBytes() const {
+    return (size_t)std::min<uint64_t>(ASSET_MAX_ENTRY_BYTES, limit_bytes_ / 4);
+}
+
+AssetCacheStats AssetCache::GetStats() const {
+    AssetCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.revalidations = revalidations_;
+    stats.stored = stored_;
+    stats.bytes_saved = bytes_saved_;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.entries = entries_.size();
+    stats.stored_bytes = stored_bytes_;
+    return stats;
+}
+
+void AssetCache::LogStats() const {
+    AssetCacheStats stats = GetStats();
+    uint64_t lookups = stats.hits + stats.misses;
+    
+    blog(LOG_INFO, "[Asset Cache] hits: %llu, misses: %llu (%.1f%% hit rate), revalidations: %llu, "
+         "stored: %llu, saved: %.1f MB, %zu assets (%.1f MB) on disk",
+         (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+         lookups ? stats.hits * 100.0 / lookups : 0.0, (unsigned long long)stats.revalidations,
+         (unsigned long long)stats.stored, stats.bytes_saved / (1024.0 * 1024.0),
+         stats.entries, stats.stored_bytes / (1024.0 * 1024.0));
+}
+
+void AssetCache::Write(std::shared_ptr<PendingAsset> asset) {
+    std::string validator = !asset->etag.empty() ? asset->etag : asset->last_modified;
+    // Another variant or CORS answer of the same version is another file
+    std::string file = GetFileName(asset->url, validator + "\n" + asset->vary + asset->allow_origin);
+    uint64_t size = asset->body.size();
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(asset->url);
+        if (it != entries_.end() && !validator.empty() && it->second.file == file) {
+            // Same version already on disk
+            it->second.expires = std::max(it->second.expires, asset->expires);
+            return;
+        }
+        if (pinned_ && stored_bytes_ + size > limit_bytes_) {
+            blog(LOG_DEBUG, "[Asset Cache] Pinned cache is full, not storing %s", asset->url.c_str());
+            return;
+        }
+    }
+    
+    QSaveFile out(QString::fromUtf8(GetPath(file).c_str()));
+    if (!out.open(QIODevice::WriteOnly) ||
+        out.write(reinterpret_cast<const char*>(asset->body.data()), (qint64)size) != (qint64)size ||
+        !out.commit()) {
+        blog(LOG_WARNING, "[Asset Cache] Could not write %s", file.c_str());
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(asset->url);
+        if (it != entries_.end()) {
+            // Previous version; an asset without validators was overwritten in place
+            if (it->second.file != file) {
+                RemoveLocked(it);
+            } else {
+                stored_bytes_ -= it->second.size;
+                entries_.erase(it);
+            }
+        }
+        
+        Entry entry;
+        entry.file = file;
+        entry.size = size;
+        entry.content_type = asset->content_type;
+        entry.etag = asset->etag;
+        entry.last_modified = asset->last_modified;
+        entry.allow_origin = asset->allow_origin;
+        entry.origin = asset->origin;
+        entry.vary = asset->vary;
+        entry.expires = asset->expires;
+        entry.last_used = (int64_t)time(nullptr);
+        entry.revalidating = false;
+        entries_[asset->url] = entry;
+        stored_bytes_ += size;
+        
+        EvictLocked(asset->url);
+    }
+    
+    stored_++;
+    blog(LOG_DEBUG, "[Asset Cache] Stored %s (%.1f KB)", asset->url.c_str(), size / 1024.0);
+    SaveIndex();
+}
+
+void AssetCache::Touch(const std::string& url) {
+    std::string file;
+    uint64_t size = 0;
+    std::shared_ptr<AssetMapping> mapping;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it == entries_.end()) {
+            return;
+        }
+        file = it->second.file;
+        size = it->second.size;
+        mapping = it->second.mapping;
+    }
+    
+    // Mapped outside the lock, like in Lookup
+    if (!mapping) {
+        mapping = MapFile(GetPath(file), size);
+        if (!mapping) {
+            return;
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it != entries_.end() && it->second.file == file && !it->second.mapping) {
+            it->second.mapping = mapping;
+        }
+    }
+    
+    // One read per page brings the whole body into the page cache
+    volatile uint8_t sink = 0;
+    for (size_t offset = 0; offset < mapping->size; offset += 4096) {
+        sink = sink + mapping->data[offset];
+    }
+}
+
+void AssetCache::EvictLocked(const std::string& keep) {
+    if (pinned_) {
+        return;
+    }
+    
+    // Least recently used first
+    while (stored_bytes_ > limit_bytes_) {
+        auto oldest = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->first != keep && (oldest == entries_.end() || it->second.last_used < oldest->second.last_used)) {
+                oldest = it;
+            }
+        }
+        if (oldest == entries_.end()) {
+            break;
+        }
+        RemoveLocked(oldest);
+    }
+}
+
+void AssetCache::RemoveLocked(std::map<std::string, Entry>::iterator it) {
+    stored_bytes_ -= it->second.size;
+    std::string path = GetPath(it->second.file);
+    entries_.erase(it);
+    
+    // Responses still reading the mapping keep it alive; where the OS
+    // refuses to delete a mapped file, the next Open sweeps it
+    QFile::remove(QString::fromUtf8(path.c_str()));
+}
+
+void AssetCache::LoadIndex() {
+    obs_data_t* index = obs_data_create_from_json_file(GetPath(ASSET_INDEX_FILE).c_str());
+    obs_data_array_t* items = index ? obs_data_get_array(index, "entries") : nullptr;
+    std::set<std::string> files;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = items ? obs_data_array_count(items) : 0;
+    for (size_t i = 0; i < count; i++) {
+        obs_data_t* item = obs_data_array_item(items, i);
+        
+        Entry entry;
+        std::string url = obs_data_get_string(item, "url");
+        entry.file = obs_data_get_string(item, "file");
+        entry.size = (uint64_t)obs_data_get_int(item, "size");
+        entry.content_type = obs_data_get_string(item, "content_type");
+        entry.etag = obs_data_get_string(item, "etag");
+        entry.last_modified = obs_data_get_string(item, "last_modified");
+        entry.allow_origin = obs_data_get_string(item, "allow_origin");
+        entry.origin = obs_data_get_string(item, "origin");
+        entry.vary = obs_data_get_string(item, "vary");
+        entry.expires = obs_data_get_int(item, "expires");
+        entry.last_used = obs_data_get_int(item, "last_used");
+        entry.revalidating = false;
+        obs_data_release(item);
+        
+        // Written by an older run that did not finish, or edited by hand
+        QFileInfo info(QString::fromUtf8(GetPath(entry.file).c_str()));
+        if (url.empty() || !info.exists() || (uint64_t)info.size() != entry.size) {
+            continue;
+        }
+        
+        files.insert(entry.file);
+        stored_bytes_ += entry.size;
+        entries_[url] = entry;
+    }
+    
+    obs_data_array_release(items);
+    obs_data_release(index);
+    
+    // Bodies no entry refers to
+    QDir directory(QString::fromUtf8(directory_.c_str()));
+    for (const QString& name : directory.entryList(QDir::Files)) {
+        std::string file = name.toStdString();
+        if (files.find(file) == files.end() &&
+            file.compare(0, strlen(ASSET_INDEX_FILE), ASSET_INDEX_FILE) != 0) {
+            directory.remove(name);
+        }
+    }
+}
+
+void AssetCache::SaveIndex() {
+    obs_data_t* index = obs_data_create();
+    obs_data_array_t* items = obs_data_array_create();
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& pair : entries_) {
+            const Entry& entry = pair.second;
+            obs_data_t* item = obs_data_create();
+            obs_data_set_string(item, "url", pair.first.c_str());
+            obs_data_set_string(item, "file", entry.file.c_str());
+            obs_data_set_int(item, "size", (long long)entry.size);
+            obs_data_set_string(item, "content_type", entry.content_type.c_str());
+            obs_data_set_string(item, "etag", entry.etag.c_str());
+            obs_data_set_string(item, "last_modified", entry.last_modified.c_str());
+            obs_data_set_string(item, "allow_origin", entry.allow_origin.c_str());
+            obs_data_set_string(item, "origin", entry.origin.c_str());
+            obs_data_set_string(item, "vary", entry.vary.c_str());
+            obs_data_set_int(item, "expires", entry.expires);
+            obs_data_set_int(item, "last_used", entry.last_used);
+            obs_data_array_push_back(items, item);
+            obs_data_release(item);
+        }
+    }
+    
+    obs_data_set_array(index, "entries", items);
+    if (!obs_data_save_json_safe(index, GetPath(ASSET_INDEX_FILE).c_str(), "tmp", "bak")) {
+        blog(LOG_WARNING, "[Asset Cache] Could not save the index");
+    }
+    obs_data_array_release(items);
+    obs_data_release(index);
+}
+
+std::string AssetCache::GetPath(const std::string& file) const {
+    return directory_ + "/" + file;
+}
+
+bool AssetCache::Matches(const Entry& entry, CefRefPtr<CefRequest> request) {
+    // The stored Access-Control-Allow-Origin has to pass this request's
+    // CORS check; requests without an Origin make none
+    std::string origin = request->GetHeaderByName("Origin").ToString();
+    if (!origin.empty() && entry.allow_origin != "*" && entry.allow_origin != origin) {
+        return false;
+    }
+    
+    if (entry.vary.empty()) {
+        return true;
+    }
+    std::string key;
+    return GetVaryKey(GetVaryNames(entry.vary), request, key) && key == entry.vary;
+}
+
+bool AssetCache::IsMedia(CefRefPtr<CefRequest> request) {
+    if (request->GetMethod().ToString() != "GET") {
+        return false;
+    }
+    
+    std::string url = request->GetURL().ToString();
+    if (url.compare(0, 7, "http://") != 0 && url.compare(0, 8, "https://") != 0) {
+        return false;
+    }
+    
+    CefRequest::ResourceType type = request->GetResourceType();
+    if (type == RT_IMAGE || type == RT_MEDIA) {
+        return true;
+    }
+    
+    // Sounds fetched by script for Web Audio are only recognisable by name
+    std::string path = url.substr(0, url.find_first_of("?#"));
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return false;
+    }
+    
+    static const char* const extensions[] = {
+        "gif", "webm", "mp4", "mp3", "ogg", "wav", "m4a", "png", "jpg", "jpeg", "webp", "apng"
+    };
+    std::string extension = ToLower(path.substr(dot + 1));
+    for (const char* candidate : extensions) {
+        if (extension == candidate) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string AssetCache::GetFileName(const std::string& url, const std::string& validator) {
+    char name[48];
+    snprintf(name, sizeof(name), "%016llx-%08llx.bin", (unsigned long long)Fnv1a(url),
+             (unsigned long long)(Fnv1a(validator) & 0xFFFFFFFFULL));
+    return name;
+}
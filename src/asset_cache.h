@@ -0,0 +1,247 @@
+#pragma once
+
+#include <include/cef_request.h>
+#include <include/cef_resource_request_handler.h>
+#include <include/cef_request_context.h>
+#include <include/cef_response.h>
+#include <obs-module.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class QFile;
+
+/**
+ * Read-only mapping of one stored asset body. Shared by every response
+ * being served from it, so an evicted asset stays readable until the last
+ * response finishes.
+ */
+struct AssetMapping {
+    std::unique_ptr<QFile> file;
+    const uint8_t* data;
+    size_t size;
+    
+    AssetMapping();
+    ~AssetMapping();
+};
+
+/**
+ * A cached asset ready to be served.
+ */
+struct AssetHit {
+    std::string url;
+    std::shared_ptr<AssetMapping> mapping;
+    std::string content_type;
+    std::string etag;
+    std::string last_modified;
+    std::string allow_origin;
+    std::string origin;        // Origin the asset was fetched for
+    std::string vary;          // see PendingAsset
+    bool revalidate;           // stale, the caller starts a revalidation
+};
+
+/**
+ * A response body captured from the network, waiting to be written.
+ */
+struct PendingAsset {
+    std::string url;
+    std::vector<uint8_t> body;
+    std::string content_type;
+    std::string etag;
+    std::string last_modified;
+    std::string allow_origin;
+    std::string origin;        // Origin header of the request, if any
+    std::string vary;          // "name:value" lines of the request headers the body varies on
+    int64_t expires;           // unix time
+};
+
+/**
+ * Counters describing how well the cache is doing.
+ */
+struct AssetCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t revalidations;    // background checks of stale assets
+    uint64_t stored;           // bodies written to disk
+    uint64_t bytes_saved;      // bytes served without touching the network
+    size_t entries;
+    uint64_t stored_bytes;
+    
+    AssetCacheStats()
+        : hits(0)
+        , misses(0)
+        , revalidations(0)
+        , stored(0)
+        , bytes_saved(0)
+        , entries(0)
+        , stored_bytes(0) {
+    }
+};
+
+/**
+ * Plugin-wide on-disk cache for alert media (images, video and audio).
+ * Bodies are captured as the page downloads them, written on the CEF file
+ * thread under a name derived from the URL and its validators, and served
+ * to later requests straight from a memory mapping, so an alert's media no
+ * longer waits for the provider's CDN. Stale assets are still served at
+ * once and revalidated in the background with their ETag/Last-Modified. In
+ * pinned mode stored assets never expire and are never evicted, so
+ * overlays keep working offline.
+ */
+class AssetCache {
+public:
+    /**
+     * Get the singleton instance of the cache.
+     */
+    static AssetCache* GetInstance();
+    
+    /**
+     * Read the plugin config and load the index of stored assets.
+     */
+    void Open();
+    
+    /**
+     * Save the index, log the final statistics and drop all mappings.
+     * Must run after CEF has shut down.
+     */
+    void Close();
+    
+    /**
+     * Get the handler that serves or captures a request, or nullptr if the
+     * request is not alert media or the cache is disabled. Called on the
+     * CEF IO thread.
+     */
+    CefRefPtr<CefResourceRequestHandler> GetRequestHandler(CefRefPtr<CefRequest> request,
+                                                           const std::string& page_url);
+    
+    /**
+     * Check whether the cache is in use.
+     */
+    bool IsEnabled() const;
+    
+    /**
+     * Check whether a body is stored for the URL, without counting a lookup.
+     */
+    bool IsStored(const std::string& url) const;
+    
+    /**
+     * Map a stored asset and read it once on the CEF file thread, so its
+     * first use does not wait for the disk.
+     */
+    void Warm(const std::string& url);
+    
+    /**
+     * Find a stored asset for the request and count the hit or miss. A
+     * stale asset without validators is a miss unless the cache is pinned.
+     * So is one stored for other values of the headers it varies on, or
+     * whose Access-Control-Allow-Origin does not admit the request's Origin.
+     */
+    bool Lookup(const std::string& url, CefRefPtr<CefRequest> request, AssetHit& hit);
+    
+    /**
+     * Check a network response and build the asset to capture from its
+     * headers and those of the request it answers.
+     * @return false if the response must not be cached, e.g. "Vary: *"
+     */
+    bool Accept(const std::string& url, CefRefPtr<CefRequest> request, CefRefPtr<CefResponse> response,
+                PendingAsset& asset) const;
+    
+    /**
+     * Queue a captured asset for writing on the CEF file thread.
+     */
+    void Store(std::shared_ptr<PendingAsset> asset);
+    
+    /**
+     * Check a stale asset with its validators in the background.
+     */
+    void Revalidate(CefRefPtr<CefRequestContext> context, const AssetHit& hit);
+    
+    /**
+     * Mark a stale asset fresh again after the server confirmed it.
+     */
+    void Refresh(const std::string& url, int64_t expires);
+    
+    /**
+     * Forget that a revalidation is running for the URL.
+     */
+    void EndRevalidate(const std::string& url);
+    
+    /**
+     * Count bytes that were served from the cache.
+     */
+    void RecordServed(uint64_t bytes);
+    
+    /**
+     * Largest body that is captured.
+     */
+    size_t GetMaxEntryBytes() const;
+    
+    /**
+     * Get a snapshot of the counters.
+     */
+    AssetCacheStats GetStats() const;
+    
+    /**
+     * Write the counters to the OBS log.
+     */
+    void LogStats() const;
+    
+private:
+    AssetCache();
+    
+    struct Entry {
+        std::string file;
+        uint64_t size;
+        std::string content_type;
+        std::string etag;
+        std::string last_modified;
+        std::string allow_origin;
+        std::string origin;
+        std::string vary;
+        int64_t expires;
+        int64_t last_used;
+        bool revalidating;
+        std::shared_ptr<AssetMapping> mapping;
+    };
+    
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+    std::string directory_;
+    uint64_t limit_bytes_;
+    uint64_t stored_bytes_;
+    bool enabled_;
+    bool pinned_;
+    
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> revalidations_;
+    std::atomic<uint64_t> stored_;
+    std::atomic<uint64_t> bytes_saved_;
+    
+    void Write(std::shared_ptr<PendingAsset> asset);
+    void Touch(const std::string& url);
+    void EvictLocked(const std::string& keep);
+    void RemoveLocked(std::map<std::string, Entry>::iterator it);
+    void LoadIndex();
+    void SaveIndex();
+    std::string GetPath(const std::string& file) const;
+    
+    static bool IsMedia(CefRefPtr<CefRequest> request);
+    static bool Matches(const Entry& entry, CefRefPtr<CefRequest> request);
+    static std::string GetFileName(const std::string& url, const std::string& validator);
+};
+
+/**
+ * Cache directory and index, under the module config directory.
+ */
+#define ASSET_CACHE_DIR "asset_cache"
+#define ASSET_INDEX_FILE "index.json"
+
+/**
+ * Bodies larger than this are never captured, whatever the cache size.
+ */
+#define ASSET_MAX_ENTRY_BYTES (32ULL * 1024 * 1024)
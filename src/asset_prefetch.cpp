@@ -0,0 +1,445 @@
+#include "asset_prefetch.h"
+#include "asset_cache.h"
+#include "plugin.h"
+#include <include/cef_urlrequest.h>
+#include <include/cef_task.h>
+#include <include/base/cef_callback.h>
+#include <include/wrapper/cef_closure_task.h>
+#include <obs-module.h>
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+/**
+ * Downloads one asset outside any page and hands it to the asset cache.
+ * With a rate limit the body is fetched in Range chunks of a fraction of a
+ * second's budget, each followed by a pause for its share of the rate, so
+ * the download itself stays under the limit rather than only the gaps
+ * between downloads.
+ */
+class PrefetchClient : public CefURLRequestClient {
+public:
+    PrefetchClient(const std::string& url, CefRefPtr<CefRequestContext> context,
+                   size_t max_bytes, size_t chunk_bytes)
+        : url_(url)
+        , context_(context)
+        , max_bytes_(max_bytes)
+        , chunk_bytes_(chunk_bytes)
+        , offset_(0)
+        , chunk_start_(0)
+        , chunk_received_(0)
+        , received_(0)
+        , overflow_(false) {
+    }
+    
+    void Start() {
+        StartChunk();
+    }
+    
+    void OnRequestComplete(CefRefPtr<CefURLRequest> request) override {
+        CefRefPtr<CefResponse> response = request->GetResponse();
+        uint64_t chunk = received_ - chunk_received_;
+        int status = response ? response->GetStatus() : 0;
+        
+        if (request->GetRequestStatus() != UR_SUCCESS || overflow_ || (status != 200 && status != 206)) {
+            Finish(false, chunk);
+            request_ = nullptr;
+            return;
+        }
+        
+        if (status == 206) {
+            unsigned long long first = 0, last = 0, total = 0;
+            std::string range = response->GetHeaderByName("Content-Range").ToString();
+            if (sscanf(range.c_str(), "bytes %llu-%llu/%llu", &first, &last, &total) != 3 ||
+                first != offset_ || last < first || total > max_bytes_) {
+                Finish(false, chunk);
+                request_ = nullptr;
+                return;
+            }
+            
+            offset_ = (size_t)last + 1;
+            if (validator_.empty()) {
+                validator_ = response->GetHeaderByName("ETag").ToString();
+            }
+            
+            if (offset_ < total) {
+                // Wait out this chunk's share of the rate before the next one
+                CefPostDelayedTask(TID_UI, base::BindOnce(&PrefetchClient::StartChunk, CefRefPtr<PrefetchClient>(this)),
+                                   AssetPrefetcher::GetInstance()->GetDelayMs(chunk));
+                request_ = nullptr;
+                return;
+            }
+        } else if (chunk_start_) {
+            // Range ignored, or the asset changed since the first chunk: this
+            // response is the whole body
+            body_.erase(body_.begin(), body_.begin() + chunk_start_);
+        }
+        
+        bool stored = false;
+        if (!body_.empty()) {
+            // A body put together from chunks is stored like a plain 200
+            CefRefPtr<CefResponse> whole = response;
+            if (status == 206) {
+                CefResponse::HeaderMap headers;
+                response->GetHeaderMap(headers);
+                whole = CefResponse::Create();
+                whole->SetStatus(200);
+                whole->SetMimeType(response->GetMimeType());
+                whole->SetHeaderMap(headers);
+            }
+            
+            auto asset = std::make_shared<PendingAsset>();
+            AssetCache* cache = AssetCache::GetInstance();
+            if (cache->Accept(url_, request->GetRequest(), whole, *asset)) {
+                asset->body = std::move(body_);
+                cache->Store(asset);
+                stored = true;
+            }
+        }
+        
+        Finish(stored, chunk);
+        request_ = nullptr;
+    }
+    
+    void OnUploadProgress(CefRefPtr<CefURLRequest> request, int64_t current, int64_t total) override {
+    }
+    
+    void OnDownloadProgress(CefRefPtr<CefURLRequest> request, int64_t current, int64_t total) override {
+    }
+    
+    void OnDownloadData(CefRefPtr<CefURLRequest> request, const void* data, size_t data_length) override {
+        received_ += data_length;
+        if (overflow_) {
+            return;
+        }
+        if (body_.size() + data_length > max_bytes_) {
+            // Too large to cache, stop spending bandwidth on it
+            overflow_ = true;
+            std::vector<uint8_t>().swap(body_);
+            request->Cancel();
+            return;
+        }
+        const uint8_t* in = static_cast<const uint8_t*>(data);
+        body_.insert(body_.end(), in, in + data_length);
+    }
+    
+private:
+    std::string url_;
+    CefRefPtr<CefRequestContext> context_;
+    size_t max_bytes_;
+    size_t chunk_bytes_;       // 0 fetches the body in one request
+    size_t offset_;            // next byte to ask for
+    size_t chunk_start_;       // body_ size when the current chunk started
+    uint64_t chunk_received_;  // received_ when the current chunk started
+    uint64_t received_;
+    bool overflow_;
+    std::string validator_;    // ETag of the first chunk, so later ones match it
+    std::vector<uint8_t> body_;
+    CefRefPtr<CefURLRequest> request_;
+    
+    void StartChunk() {
+        CefRefPtr<CefRequest> request = CefRequest::Create();
+        request->SetURL(url_);
+        request->SetMethod("GET");
+        
+        if (chunk_bytes_) {
+            char range[64];
+            snprintf(range, sizeof(range), "bytes=%zu-%zu", offset_, offset_ + chunk_bytes_ - 1);
+            request->SetHeaderByName("Range", range, true);
+            if (!validator_.empty()) {
+                request->SetHeaderByName("If-Range", validator_, true);
+            }
+        }
+        
+        chunk_start_ = body_.size();
+        chunk_received_ = received_;
+        
+        // Holds the request until it completes; released in OnRequestComplete
+        request_ = CefURLRequest::Create(request, this, context_);
+        if (!request_) {
+            Finish(false, 0);
+        }
+    }
+    
+    void Finish(bool stored, uint64_t chunk) {
+        // The last chunk gets its pause too before the next download starts
+        CefPostDelayedTask(TID_UI, base::BindOnce(&AssetPrefetcher::OnFetched,
+                                                  base::Unretained(AssetPrefetcher::GetInstance()),
+                                                  url_, stored, received_),
+                           AssetPrefetcher::GetInstance()->GetDelayMs(chunk));
+    }
+    
+    IMPLEMENT_REFCOUNTING(PrefetchClient);
+};
+
+} // namespace
+
+AssetPrefetcher* AssetPrefetcher::GetInstance() {
+    static AssetPrefetcher instance;
+    return &instance;
+}
+
+AssetPrefetcher::AssetPrefetcher()
+    : busy_(false)
+    , open_(false)
+    , rate_bytes_(0)
+    , learned_dirty_(false) {
+}
+
+void AssetPrefetcher::Open() {
+    obs_data_t* config = ChromiumPlugin::GetInstance()->GetConfig();
+    long long rate_kb = config ? obs_data_get_int(config, CONFIG_PREFETCH_RATE) : 0;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    rate_bytes_ = rate_kb > 0 ? (uint64_t)rate_kb * 1024 : 0;
+    open_ = true;
+    LoadLearned();
+}
+
+void AssetPrefetcher::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_) {
+            return;
+        }
+        open_ = false;
+        queue_.clear();
+        queued_.clear();
+        SaveLearned();
+    }
+    LogStats();
+}
+
+void AssetPrefetcher::RecordFetch(const std::string& page_url, const std::string& asset_url) {
+    std::string page = GetPageKey(page_url);
+    if (page.empty()) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string>& urls = learned_[page];
+    auto it = std::find(urls.begin(), urls.end(), asset_url);
+    if (it == urls.begin() && !urls.empty()) {
+        return;
+    }
+    if (it != urls.end()) {
+        urls.erase(it);
+    }
+    urls.insert(urls.begin(), asset_url);
+    if (urls.size() > PREFETCH_MAX_URLS) {
+        urls.resize(PREFETCH_MAX_URLS);
+    }
+    learned_dirty_ = true;
+}
+
+void AssetPrefetcher::Schedule(const std::string& page_url, int mode, const std::vector<std::string>& manifest,
+                               CefRefPtr<CefRequestContext> context) {
+    AssetCache* cache = AssetCache::GetInstance();
+    if (mode == PREFETCH_MODE_OFF || !cache->IsEnabled()) {
+        return;
+    }
+    
+    size_t queued = 0;
+    size_t warmed = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_) {
+            return;
+        }
+        
+        std::vector<std::string> urls;
+        if (mode == PREFETCH_MODE_MANIFEST) {
+            urls = manifest;
+        } else {
+            auto it = learned_.find(GetPageKey(page_url));
+            if (it != learned_.end()) {
+                urls = it->second;
+            }
+        }
+        if (urls.size() > PREFETCH_MAX_URLS) {
+            urls.resize(PREFETCH_MAX_URLS);
+        }
+        
+        for (const std::string& url : urls) {
+            if (cache->IsStored(url)) {
+                cache->Warm(url);
+                warmed++;
+            } else if (queued_.insert(url).second) {
+                queue_.push_back({url, context});
+                queued++;
+            }
+        }
+        stats_.queued += queued;
+        stats_.warmed += warmed;
+    }
+    
+    if (queued || warmed) {
+        blog(LOG_INFO, "[Asset Prefetch] %zu assets queued, %zu warmed for %s",
+             queued, warmed, page_url.c_str());
+    }
+    StartNext();
+}
+
+void AssetPrefetcher::OnFetched(const std::string& url, bool stored, uint64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_ = false;
+        queued_.erase(url);
+        if (stored) {
+            stats_.fetched++;
+        } else {
+            stats_.failed++;
+        }
+        stats_.bytes += bytes;
+    }
+    
+    // The download already paused for its own chunks
+    StartNext();
+}
+
+size_t AssetPrefetcher::GetChunkBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!rate_bytes_) {
+        return 0;
+    }
+    return (size_t)std::max<uint64_t>(rate_bytes_ * PREFETCH_CHUNK_MS / 1000, PREFETCH_MIN_CHUNK_BYTES);
+}
+
+int64_t AssetPrefetcher::GetDelayMs(uint64_t bytes) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rate_bytes_ ? (int64_t)(bytes * 1000 / rate_bytes_) : 0;
+}
+
+PrefetchStats AssetPrefetcher::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void AssetPrefetcher::LogStats() const {
+    PrefetchStats stats = GetStats();
+    
+    blog(LOG_INFO, "[Asset Prefetch] queued: %llu, fetched: %llu (%.1f MB), warmed: %llu, failed: %llu",
+         (unsigned long long)stats.queued, (unsigned long long)stats.fetched,
+         stats.bytes / (1024.0 * 1024.0), (unsigned long long)stats.warmed,
+         (unsigned long long)stats.failed);
+}
+
+std::vector<std::string> AssetPrefetcher::ParseManifest(const std::string& text) {
+    std::vector<std::string> urls;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line) && urls.size() < PREFETCH_MAX_URLS) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        size_t end = line.find_last_not_of(" \t\r");
+        if (begin == std::string::npos) {
+            continue;
+        }
+        line = line.substr(begin, end + 1 - begin);
+        if (line.compare(0, 7, "http://") == 0 || line.compare(0, 8, "https://") == 0) {
+            urls.push_back(line);
+        }
+    }
+    return urls;
+}
+
+void AssetPrefetcher::StartNext() {
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_ || busy_) {
+            return;
+        }
+        
+        // Queued twice, or stored meanwhile by a page that got there first
+        while (!queue_.empty() && AssetCache::GetInstance()->IsStored(queue_.front().url)) {
+            queued_.erase(queue_.front().url);
+            queue_.pop_front();
+        }
+        if (queue_.empty()) {
+            if (learned_dirty_) {
+                SaveLearned();
+            }
+            return;
+        }
+        
+        job = queue_.front();
+        queue_.pop_front();
+        busy_ = true;
+    }
+    
+    CefRefPtr<PrefetchClient> client = new PrefetchClient(job.url, job.context,
+                                                          AssetCache::GetInstance()->GetMaxEntryBytes(),
+                                                          GetChunkBytes());
+    client->Start();
+}
+
+void AssetPrefetcher::LoadLearned() {
+    char* path = obs_module_config_path(PREFETCH_LEARNED_FILE);
+    obs_data_t* data = path ? obs_data_create_from_json_file(path) : nullptr;
+    bfree(path);
+    obs_data_array_t* pages = data ? obs_data_get_array(data, "pages") : nullptr;
+    
+    size_t count = pages ? obs_data_array_count(pages) : 0;
+    for (size_t i = 0; i < count; i++) {
+        obs_data_t* page = obs_data_array_item(pages, i);
+        obs_data_array_t* assets = obs_data_get_array(page, "assets");
+        
+        std::vector<std::string>& urls = learned_[obs_data_get_string(page, "url")];
+        size_t assets_count = assets ? obs_data_array_count(assets) : 0;
+        for (size_t j = 0; j < assets_count && urls.size() < PREFETCH_MAX_URLS; j++) {
+            obs_data_t* asset = obs_data_array_item(assets, j);
+            urls.push_back(obs_data_get_string(asset, "url"));
+            obs_data_release(asset);
+        }
+        
+        obs_data_array_release(assets);
+        obs_data_release(page);
+    }
+    
+    obs_data_array_release(pages);
+    obs_data_release(data);
+}
+
+void AssetPrefetcher::SaveLearned() {
+    if (!learned_dirty_) {
+        return;
+    }
+    
+    obs_data_t* data = obs_data_create();
+    obs_data_array_t* pages = obs_data_array_create();
+    for (const auto& pair : learned_) {
+        obs_data_t* page = obs_data_create();
+        obs_data_array_t* assets = obs_data_array_create();
+        for (const std::string& url : pair.second) {
+            obs_data_t* asset = obs_data_create();
+            obs_data_set_string(asset, "url", url.c_str());
+            obs_data_array_push_back(assets, asset);
+            obs_data_release(asset);
+        }
+        obs_data_set_string(page, "url", pair.first.c_str());
+        obs_data_set_array(page, "assets", assets);
+        obs_data_array_push_back(pages, page);
+        obs_data_array_release(assets);
+        obs_data_release(page);
+    }
+    obs_data_set_array(data, "pages", pages);
+    
+    char* path = obs_module_config_path(PREFETCH_LEARNED_FILE);
+    if (path && obs_data_save_json_safe(data, path, "tmp", "bak")) {
+        learned_dirty_ = false;
+    } else {
+        blog(LOG_WARNING, "[Asset Prefetch] Could not save learned manifests");
+    }
+    bfree(path);
+    obs_data_array_release(pages);
+    obs_data_release(data);
+}
+
+std::string AssetPrefetcher::GetPageKey(const std::string& page_url) {
+    if (page_url.compare(0, 7, "http://") != 0 && page_url.compare(0, 8, "https://") != 0 &&
+        page_url.compare(0, 7, "file://") != 0) {
+        return std::string();
+    }
+    return page_url.substr(0, page_url.find('#'));
+}
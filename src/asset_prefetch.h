@@ -0,0 +1,150 @@
+#pragma once
+
+#include <include/cef_request_context.h>
+#include <obs-module.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Counters describing prefetch activity.
+ */
+struct PrefetchStats {
+    uint64_t queued;
+    uint64_t fetched;          // downloaded and handed to the asset cache
+    uint64_t warmed;           // already stored, read into memory
+    uint64_t failed;
+    uint64_t bytes;
+    
+    PrefetchStats()
+        : queued(0)
+        , fetched(0)
+        , warmed(0)
+        , failed(0)
+        , bytes(0) {
+    }
+};
+
+/**
+ * Fills the asset cache with a page's alert media once the page has loaded,
+ * so the first alert after starting OBS does not wait for the CDN. The
+ * list comes from the source's manifest or is learned from the media pages
+ * loaded in earlier sessions. Downloads run one at a time and, with a rate
+ * limit, in Range chunks paced to that limit, so prefetching never competes
+ * with the stream for bandwidth.
+ */
+class AssetPrefetcher {
+public:
+    /**
+     * Get the singleton instance of the prefetcher.
+     */
+    static AssetPrefetcher* GetInstance();
+    
+    /**
+     * Read the rate limit and the learned manifests.
+     */
+    void Open();
+    
+    /**
+     * Drop queued downloads, save the learned manifests and log the
+     * statistics. Must run after CEF has shut down.
+     */
+    void Close();
+    
+    /**
+     * Remember that a page loaded a media URL. Called on the CEF IO thread.
+     */
+    void RecordFetch(const std::string& page_url, const std::string& asset_url);
+    
+    /**
+     * Queue a page's media after it finished loading. Called on the CEF UI
+     * thread.
+     * @param mode PREFETCH_MODE_*
+     * @param manifest URLs used with PREFETCH_MODE_MANIFEST
+     */
+    void Schedule(const std::string& page_url, int mode, const std::vector<std::string>& manifest,
+                  CefRefPtr<CefRequestContext> context);
+    
+    /**
+     * Called by a download when it finishes. CEF UI thread.
+     */
+    void OnFetched(const std::string& url, bool stored, uint64_t bytes);
+    
+    /**
+     * Size of the Range requests a download is split into.
+     * @return 0 without a rate limit, to fetch each asset in one request
+     */
+    size_t GetChunkBytes() const;
+    
+    /**
+     * Pause owed after reading some bytes under the rate limit.
+     */
+    int64_t GetDelayMs(uint64_t bytes) const;
+    
+    /**
+     * Get a snapshot of the counters.
+     */
+    PrefetchStats GetStats() const;
+    
+    /**
+     * Write the counters to the OBS log.
+     */
+    void LogStats() const;
+    
+    /**
+     * Split a manifest typed into the source properties into URLs.
+     */
+    static std::vector<std::string> ParseManifest(const std::string& text);
+    
+private:
+    AssetPrefetcher();
+    
+    struct Job {
+        std::string url;
+        CefRefPtr<CefRequestContext> context;
+    };
+    
+    mutable std::mutex mutex_;
+    std::deque<Job> queue_;
+    std::set<std::string> queued_;
+    bool busy_;
+    bool open_;
+    uint64_t rate_bytes_;                                  // per second, 0 = unlimited
+    std::map<std::string, std::vector<std::string>> learned_; // page -> media, newest first
+    bool learned_dirty_;
+    PrefetchStats stats_;
+    
+    void StartNext();
+    void LoadLearned();
+    void SaveLearned();
+    
+    static std::string GetPageKey(const std::string& page_url);
+};
+
+/**
+ * Where a source's prefetch list comes from.
+ */
+#define PREFETCH_MODE_OFF 0
+#define PREFETCH_MODE_LEARNED 1    // media the page loaded in earlier sessions
+#define PREFETCH_MODE_MANIFEST 2   // URLs listed in the source properties
+
+/**
+ * Most media URLs remembered or prefetched per page.
+ */
+#define PREFETCH_MAX_URLS 64
+
+/**
+ * Range chunk sizing when a rate limit is set: a quarter second of budget,
+ * but never so small that request overhead dominates.
+ */
+#define PREFETCH_CHUNK_MS 250
+#define PREFETCH_MIN_CHUNK_BYTES 16384
+
+/**
+ * Learned manifests, in the module config directory.
+ */
+#define PREFETCH_LEARNED_FILE "prefetch_learned.json"
@@ -0,0 +1,167 @@
+#include "browser_health.h"
+#include <algorithm>
+
+BrowserHealth::BrowserHealth()
+    : last_paint_ns_(0)
+    , page_loaded_(false)
+    , renderer_crashes_(0)
+    , renderer_terminated_(false)
+    , heartbeat_seq_(0)
+    , heartbeat_sent_ns_(0)
+    , heartbeat_outstanding_(false)
+    , heartbeat_rtt_ms_(0.0)
+    , backoff_ns_(HEALTH_BACKOFF_MIN_NS)
+    , next_reload_ns_(0)
+    , last_reload_ns_(0)
+    , health_reloads_(0)
+    , state_(HealthState::Starting) {
+}
+
+void BrowserHealth::Reset(uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Backoff and counters survive so a crash-looping page stays throttled
+    last_paint_ns_ = now_ns;
+    page_loaded_ = false;
+    renderer_terminated_ = false;
+    heartbeat_sent_ns_ = 0;
+    heartbeat_outstanding_ = false;
+    heartbeat_rtt_ms_ = 0.0;
+    load_errors_.clear();
+    state_ = HealthState::Starting;
+    reason_.clear();
+}
+
+void BrowserHealth::RecordPaint(uint64_t now_ns) {
+    last_paint_ns_ = now_ns;
+}
+
+void BrowserHealth::RecordLoadEnd(uint64_t now_ns) {
+    page_loaded_ = true;
+    last_paint_ns_ = now_ns;
+}
+
+void BrowserHealth::RecordLoadError(uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    load_errors_.push_back(now_ns);
+    PruneLoadErrors(now_ns);
+}
+
+void BrowserHealth::RecordRendererTerminated() {
+    renderer_crashes_++;
+    renderer_terminated_ = true;
+}
+
+void BrowserHealth::RecordHeartbeatAck(uint32_t seq, uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!heartbeat_outstanding_ || seq != heartbeat_seq_) {
+        return;
+    }
+    
+    heartbeat_outstanding_ = false;
+    heartbeat_rtt_ms_ = (now_ns - heartbeat_sent_ns_) / 1000000.0;
+}
+
+uint32_t BrowserHealth::NextHeartbeat(uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!page_loaded_ || heartbeat_outstanding_) {
+        return 0;
+    }
+    if (heartbeat_sent_ns_ && now_ns - heartbeat_sent_ns_ < HEALTH_HEARTBEAT_INTERVAL_NS) {
+        return 0;
+    }
+    
+    if (++heartbeat_seq_ == 0) {
+        heartbeat_seq_ = 1;
+    }
+    heartbeat_sent_ns_ = now_ns;
+    heartbeat_outstanding_ = true;
+    return heartbeat_seq_;
+}
+
+HealthState BrowserHealth::Evaluate(uint64_t now_ns, bool expect_paints) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PruneLoadErrors(now_ns);
+    
+    HealthState state = HealthState::Healthy;
+    const char* reason = "";
+    uint64_t last_paint = last_paint_ns_;
+    
+    if (renderer_terminated_) {
+        state = HealthState::Failed;
+        reason = "renderer process terminated";
+    } else if (load_errors_.size() >= HEALTH_LOAD_ERROR_BURST) {
+        state = HealthState::Failed;
+        reason = "repeated load errors";
+    } else if (!page_loaded_) {
+        state = HealthState::Starting;
+    } else if (heartbeat_outstanding_ && now_ns - heartbeat_sent_ns_ > HEALTH_HEARTBEAT_TIMEOUT_NS) {
+        state = HealthState::Failed;
+        reason = "heartbeat timed out";
+    } else if (expect_paints && now_ns > last_paint && now_ns - last_paint > HEALTH_PAINT_STALL_NS) {
+        state = HealthState::Failed;
+        reason = "no frames painted";
+    } else if (heartbeat_rtt_ms_ > HEALTH_HEARTBEAT_SLOW_MS) {
+        state = HealthState::Degraded;
+        reason = "slow heartbeat";
+    }
+    
+    // A long healthy run earns back the short backoff
+    if (state == HealthState::Healthy && backoff_ns_ > HEALTH_BACKOFF_MIN_NS &&
+        now_ns - last_reload_ns_ > HEALTH_BACKOFF_RESET_NS) {
+        backoff_ns_ = HEALTH_BACKOFF_MIN_NS;
+    }
+    
+    state_ = state;
+    reason_ = reason;
+    return state;
+}
+
+bool BrowserHealth::ConsumeReload(uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (now_ns < next_reload_ns_) {
+        return false;
+    }
+    
+    health_reloads_++;
+    last_reload_ns_ = now_ns;
+    next_reload_ns_ = now_ns + backoff_ns_;
+    backoff_ns_ = std::min<uint64_t>(backoff_ns_ * 2, HEALTH_BACKOFF_MAX_NS);
+    return true;
+}
+
+HealthSnapshot BrowserHealth::GetSnapshot(uint64_t now_ns) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t last_paint = last_paint_ns_;
+    
+    HealthSnapshot snapshot;
+    snapshot.state = state_;
+    snapshot.reason = reason_;
+    snapshot.since_paint_ms = now_ns > last_paint ? (now_ns - last_paint) / 1000000.0 : 0.0;
+    snapshot.heartbeat_rtt_ms = heartbeat_rtt_ms_;
+    snapshot.recent_load_errors = (uint32_t)load_errors_.size();
+    snapshot.renderer_crashes = renderer_crashes_;
+    snapshot.health_reloads = health_reloads_;
+    snapshot.backoff_s = backoff_ns_ / 1000000000.0;
+    return snapshot;
+}
+
+const char* BrowserHealth::StateName(HealthState state) {
+    switch (state) {
+        case HealthState::Starting:
+            return "Starting";
+        case HealthState::Healthy:
+            return "Healthy";
+        case HealthState::Degraded:
+            return "Degraded";
+        case HealthState::Failed:
+            return "Failed";
+    }
+    return "Unknown";
+}
+
+void BrowserHealth::PruneLoadErrors(uint64_t now_ns) {
+    while (!load_errors_.empty() && now_ns - load_errors_.front() > HEALTH_LOAD_ERROR_WINDOW_NS) {
+        load_errors_.pop_front();
+    }
+}
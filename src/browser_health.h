@@ -0,0 +1,131 @@
+#pragma once
+
+#include <obs-module.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+/**
+ * Overall health of a browser as judged by BrowserHealth::Evaluate.
+ */
+enum class HealthState {
+    Starting,   // page has not finished loading yet
+    Healthy,
+    Degraded,   // slow but alive, no action taken
+    Failed      // evidence of failure, a reload is warranted
+};
+
+/**
+ * Point-in-time view of the health signals for display and logging.
+ */
+struct HealthSnapshot {
+    HealthState state;
+    std::string reason;
+    double since_paint_ms;
+    double heartbeat_rtt_ms;
+    uint32_t recent_load_errors;
+    uint32_t renderer_crashes;
+    uint32_t health_reloads;
+    double backoff_s;
+};
+
+/**
+ * Tracks liveness signals for one browser and decides when it needs a
+ * reload. Signals are recorded from CEF threads; evaluation happens on the
+ * OBS graphics thread from VideoTick. Reloads are rate-limited with an
+ * exponential backoff that resets after a sustained healthy period.
+ */
+class BrowserHealth {
+public:
+    BrowserHealth();
+    
+    /**
+     * Forget all signals, e.g. after a new page has been swapped in.
+     */
+    void Reset(uint64_t now_ns);
+    
+    // Signals recorded from CEF threads
+    void RecordPaint(uint64_t now_ns);
+    void RecordLoadEnd(uint64_t now_ns);
+    void RecordLoadError(uint64_t now_ns);
+    void RecordRendererTerminated();
+    void RecordHeartbeatAck(uint32_t seq, uint64_t now_ns);
+    
+    /**
+     * Get the sequence number of the next heartbeat to send, or 0 if none
+     * is due yet. A new heartbeat is not issued while one is outstanding.
+     */
+    uint32_t NextHeartbeat(uint64_t now_ns);
+    
+    /**
+     * Evaluate the collected signals.
+     * @param expect_paints true when the page is being invalidated every
+     *        frame, so a lack of paints means the renderer is stuck
+     */
+    HealthState Evaluate(uint64_t now_ns, bool expect_paints);
+    
+    /**
+     * Check whether a reload may be issued now given the current backoff,
+     * and if so account for it and extend the backoff.
+     */
+    bool ConsumeReload(uint64_t now_ns);
+    
+    /**
+     * Get the latest evaluation and signal values.
+     */
+    HealthSnapshot GetSnapshot(uint64_t now_ns) const;
+    
+    /**
+     * Human readable name of a health state.
+     */
+    static const char* StateName(HealthState state);
+    
+private:
+    mutable std::mutex mutex_;
+    
+    std::atomic<uint64_t> last_paint_ns_;
+    std::atomic<bool> page_loaded_;
+    std::atomic<uint32_t> renderer_crashes_;
+    std::atomic<bool> renderer_terminated_;
+    
+    // Heartbeat round trips
+    uint32_t heartbeat_seq_;
+    uint64_t heartbeat_sent_ns_;
+    bool heartbeat_outstanding_;
+    double heartbeat_rtt_ms_;
+    
+    // Load errors within HEALTH_LOAD_ERROR_WINDOW_NS
+    std::deque<uint64_t> load_errors_;
+    
+    // Reload backoff
+    uint64_t backoff_ns_;
+    uint64_t next_reload_ns_;
+    uint64_t last_reload_ns_;
+    uint32_t health_reloads_;
+    
+    HealthState state_;
+    std::string reason_;
+    
+    void PruneLoadErrors(uint64_t now_ns);
+};
+
+/**
+ * Heartbeat protocol. The page echoes the sequence number through the
+ * console, which the display handler intercepts.
+ */
+#define HEALTH_HEARTBEAT_PREFIX "__obs_chromium_heartbeat__:"
+
+/**
+ * Health thresholds.
+ */
+#define HEALTH_HEARTBEAT_INTERVAL_NS 5000000000ULL   // 5 seconds
+#define HEALTH_HEARTBEAT_TIMEOUT_NS 15000000000ULL   // 15 seconds
+#define HEALTH_HEARTBEAT_SLOW_MS 1000.0
+#define HEALTH_PAINT_STALL_NS 10000000000ULL         // 10 seconds
+#define HEALTH_LOAD_ERROR_WINDOW_NS 60000000000ULL   // 1 minute
+#define HEALTH_LOAD_ERROR_BURST 3
+#define HEALTH_BACKOFF_MIN_NS 10000000000ULL         // 10 seconds
+#define HEALTH_BACKOFF_MAX_NS 600000000000ULL        // 10 minutes
+#define HEALTH_BACKOFF_RESET_NS 900000000000ULL      // 15 minutes healthy
@@ -0,0 +1,185 @@
+#include "browser_pool.h"
+#include "cef_browser.h"
+#include "plugin.h"
+#include <include/cef_task.h>
+#include <include/base/cef_callback.h>
+#include <include/wrapper/cef_closure_task.h>
+#include <obs-module.h>
+#include <util/platform.h>
+
+BrowserPool* BrowserPool::GetInstance() {
+    static BrowserPool instance;
+    return &instance;
+}
+
+BrowserPool::BrowserPool()
+    : capacity_(0)
+    , spawning_(0)
+    , width_(DEFAULT_WIDTH)
+    , height_(DEFAULT_HEIGHT) {
+}
+
+void BrowserPool::Configure(size_t capacity, int width, int height) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        width_ = width;
+        height_ = height;
+    }
+    
+    blog(LOG_INFO, "[Browser Pool] Configured for %zu browsers at %dx%d",
+         capacity, width, height);
+}
+
+std::unique_ptr<CEFBrowser> BrowserPool::Checkout(std::shared_ptr<ChromiumSource> source,
+                                                  const std::string& url,
+                                                  int width, int height) {
+    std::unique_ptr<CEFBrowser> browser;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        // Skip browsers whose renderer went away while parked
+        while (!idle_.empty() && !browser) {
+            browser = std::move(idle_.front());
+            idle_.pop_front();
+            if (!browser->IsValid()) {
+                browser.reset();
+            }
+        }
+        
+        if (browser) {
+            stats_.hits++;
+        } else {
+            stats_.misses++;
+        }
+    }
+    
+    if (!browser) {
+        blog(LOG_INFO, "[Browser Pool] Pool miss, browser will be created on demand");
+        Refill();
+        return nullptr;
+    }
+    
+    browser->SetSource(std::move(source));
+    browser->Resize(width, height);
+    browser->LoadURL(url);
+    
+    // Replace the browser we just handed out
+    Refill();
+    return browser;
+}
+
+void BrowserPool::Return(std::unique_ptr<CEFBrowser> browser) {
+    if (!browser) {
+        return;
+    }
+    
+    browser->SetSource(nullptr);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (browser->IsValid() && idle_.size() + spawning_ < capacity_) {
+        browser->LoadURL(POOL_PARKING_URL);
+        browser->Resize(width_, height_);
+        browser->SetDeviceScale(1.0f);
+        browser->SetRenderTier(RenderTier::Hidden);
+        idle_.push_back(std::move(browser));
+        stats_.returned++;
+        return;
+    }
+    
+    browser->Close();
+}
+
+void BrowserPool::Refill() {
+    if (!CEFManager::IsInitialized()) {
+        return;
+    }
+    
+    size_t missing = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t have = idle_.size() + spawning_;
+        if (have < capacity_) {
+            missing = capacity_ - have;
+            spawning_ += missing;
+        }
+    }
+    
+    // Browser creation has to happen on the CEF UI thread
+    for (size_t i = 0; i < missing; ++i) {
+        CefPostTask(TID_UI, base::BindOnce(&BrowserPool::SpawnOne, base::Unretained(this)));
+    }
+}
+
+void BrowserPool::SpawnOne() {
+    CEF_REQUIRE_UI_THREAD();
+    
+    int width, height;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        width = width_;
+        height = height_;
+    }
+    
+    uint64_t start_ns = os_gettime_ns();
+    
+    auto browser = std::make_unique<CEFBrowser>(nullptr);
+    bool ok = browser->Initialize(POOL_PARKING_URL, width, height);
+    
+    double spawn_ms = (os_gettime_ns() - start_ns) / 1000000.0;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    spawning_--;
+    
+    if (!ok) {
+        blog(LOG_WARNING, "[Browser Pool] Failed to spawn pooled browser");
+        return;
+    }
+    
+    stats_.spawned++;
+    stats_.last_spawn_ms = spawn_ms;
+    stats_.avg_spawn_ms += (spawn_ms - stats_.avg_spawn_ms) / (double)stats_.spawned;
+    
+    if (idle_.size() >= capacity_) {
+        // Pool was shrunk or cleared while we were spawning
+        browser->Close();
+        return;
+    }
+    
+    // Parked browsers have nothing to show
+    browser->SetRenderTier(RenderTier::Hidden);
+    idle_.push_back(std::move(browser));
+}
+
+void BrowserPool::Clear() {
+    std::deque<std::unique_ptr<CEFBrowser>> idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle.swap(idle_);
+        capacity_ = 0;
+    }
+    
+    for (auto& browser : idle) {
+        browser->Close();
+    }
+}
+
+BrowserPoolStats BrowserPool::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BrowserPoolStats stats = stats_;
+    stats.idle = idle_.size();
+    return stats;
+}
+
+void BrowserPool::LogStats() const {
+    BrowserPoolStats stats = GetStats();
+    uint64_t requests = stats.hits + stats.misses;
+    
+    blog(LOG_INFO, "[Browser Pool] hits: %llu, misses: %llu (%.1f%% hit rate), "
+         "spawned: %llu, returned: %llu, idle: %zu, spawn latency: %.1f ms avg / %.1f ms last",
+         (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+         requests ? 100.0 * stats.hits / requests : 0.0,
+         (unsigned long long)stats.spawned, (unsigned long long)stats.returned,
+         stats.idle, stats.avg_spawn_ms, stats.last_spawn_ms);
+}
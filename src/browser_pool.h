@@ -0,0 +1,105 @@
+#pragma once
+
+#include <obs-module.h>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+// Forward declarations
+class CEFBrowser;
+struct ChromiumSource;
+
+/**
+ * Counters describing how well the pool is serving browser requests.
+ */
+struct BrowserPoolStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t spawned;
+    uint64_t returned;
+    double last_spawn_ms;
+    double avg_spawn_ms;
+    size_t idle;
+    
+    BrowserPoolStats()
+        : hits(0)
+        , misses(0)
+        , spawned(0)
+        , returned(0)
+        , last_spawn_ms(0.0)
+        , avg_spawn_ms(0.0)
+        , idle(0) {
+    }
+};
+
+/**
+ * Pool of pre-spawned windowless browsers parked on about:blank.
+ * Sources check a browser out instead of paying for renderer-process
+ * startup, and hand it back when they no longer need it. The pool is
+ * refilled on the CEF UI thread so callers never block on creation.
+ */
+class BrowserPool {
+public:
+    /**
+     * Get the singleton instance of the pool.
+     */
+    static BrowserPool* GetInstance();
+    
+    /**
+     * Set the number of idle browsers to keep and their initial size.
+     * A capacity of 0 disables the pool.
+     */
+    void Configure(size_t capacity, int width, int height);
+    
+    /**
+     * Take an idle browser, attach it to the source and navigate it.
+     * @return nullptr on a pool miss; the caller creates its own browser
+     */
+    std::unique_ptr<CEFBrowser> Checkout(std::shared_ptr<ChromiumSource> source,
+                                         const std::string& url,
+                                         int width, int height);
+    
+    /**
+     * Give a browser back. It is detached, parked on about:blank and kept
+     * if the pool has room, otherwise closed.
+     */
+    void Return(std::unique_ptr<CEFBrowser> browser);
+    
+    /**
+     * Schedule creation of browsers until the pool is back at capacity.
+     */
+    void Refill();
+    
+    /**
+     * Close all idle browsers. Must run before CEF shuts down.
+     */
+    void Clear();
+    
+    /**
+     * Get a snapshot of the pool counters.
+     */
+    BrowserPoolStats GetStats() const;
+    
+    /**
+     * Write the pool counters to the OBS log.
+     */
+    void LogStats() const;
+    
+private:
+    BrowserPool();
+    
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<CEFBrowser>> idle_;
+    size_t capacity_;
+    size_t spawning_;
+    int width_;
+    int height_;
+    BrowserPoolStats stats_;
+    
+    // Runs on the CEF UI thread
+    void SpawnOne();
+};
+
+#define POOL_PARKING_URL "about:blank"
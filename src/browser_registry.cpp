@@ -0,0 +1,164 @@
+#include "browser_registry.h"
+#include "plugin.h"
+#include "chromium_source.h"
+#include "memory_watchdog.h"
+#include <obs-module.h>
+#include <algorithm>
+
+BrowserRegistry* BrowserRegistry::GetInstance() {
+    static BrowserRegistry instance;
+    return &instance;
+}
+
+BrowserRegistry::BrowserRegistry() {
+}
+
+std::shared_ptr<ChromiumSource> BrowserRegistry::Join(ChromiumSourceImpl* member, const BrowserKey& key,
+                                                      obs_source_t* source, bool& owner) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    Entry& entry = entries_[key];
+    if (!entry.frame) {
+        // Paint target shared with the CEF handlers
+        entry.frame = std::make_shared<ChromiumSource>();
+        entry.frame->source = source;
+        MemoryWatchdog::GetInstance()->Register(entry.frame.get());
+    }
+    
+    entry.members.push_back(member);
+    entry.sources.push_back(source);
+    keys_[member] = key;
+    
+    owner = entry.members.size() == 1;
+    if (!owner) {
+        blog(LOG_INFO, "[Browser Registry] '%s' shares the browser of '%s' (%zu sources)",
+             obs_source_get_name(source), obs_source_get_name(entry.sources.front()),
+             entry.members.size());
+        LogCounts();
+    }
+    return entry.frame;
+}
+
+ChromiumSourceImpl* BrowserRegistry::Leave(ChromiumSourceImpl* member) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto key_it = keys_.find(member);
+    if (key_it == keys_.end()) {
+        return nullptr;
+    }
+    
+    auto entry_it = entries_.find(key_it->second);
+    keys_.erase(key_it);
+    if (entry_it == entries_.end()) {
+        return nullptr;
+    }
+    
+    Entry& entry = entry_it->second;
+    auto pos = std::find(entry.members.begin(), entry.members.end(), member);
+    if (pos == entry.members.end()) {
+        return nullptr;
+    }
+    
+    bool was_owner = pos == entry.members.begin();
+    entry.sources.erase(entry.sources.begin() + (pos - entry.members.begin()));
+    entry.members.erase(pos);
+    
+    if (entry.members.empty()) {
+        MemoryWatchdog::GetInstance()->Unregister(entry.frame.get());
+        entries_.erase(entry_it);
+        return nullptr;
+    }
+    
+    if (!was_owner) {
+        return nullptr;
+    }
+    
+    entry.frame->source = entry.sources.front();
+    blog(LOG_INFO, "[Browser Registry] '%s' takes over the shared browser",
+         obs_source_get_name(entry.sources.front()));
+    return entry.members.front();
+}
+
+bool BrowserRegistry::Rekey(ChromiumSourceImpl* member, const BrowserKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto key_it = keys_.find(member);
+    if (key_it == keys_.end() || entries_.count(key)) {
+        return false;
+    }
+    
+    auto entry_it = entries_.find(key_it->second);
+    if (entry_it == entries_.end() || entry_it->second.members.size() != 1) {
+        return false;
+    }
+    
+    Entry entry = std::move(entry_it->second);
+    entries_.erase(entry_it);
+    entries_[key] = std::move(entry);
+    key_it->second = key;
+    return true;
+}
+
+void BrowserRegistry::ApplyOwnerRenderTier(ChromiumSourceImpl* member) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto key_it = keys_.find(member);
+    if (key_it == keys_.end()) {
+        return;
+    }
+    
+    auto entry_it = entries_.find(key_it->second);
+    if (entry_it == entries_.end() || entry_it->second.members.empty()) {
+        return;
+    }
+    
+    ChromiumSourceImpl* owner = entry_it->second.members.front();
+    if (owner != member) {
+        owner->ApplyRenderTier();
+    }
+}
+
+size_t BrowserRegistry::GetShareCount(const ChromiumSourceImpl* member) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto key_it = keys_.find(member);
+    if (key_it == keys_.end()) {
+        return 0;
+    }
+    
+    auto entry_it = entries_.find(key_it->second);
+    return entry_it == entries_.end() ? 0 : entry_it->second.members.size();
+}
+
+std::vector<obs_source_t*> BrowserRegistry::GetSources(const ChromiumSourceImpl* member) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto key_it = keys_.find(member);
+    if (key_it == keys_.end()) {
+        return std::vector<obs_source_t*>();
+    }
+    
+    auto entry_it = entries_.find(key_it->second);
+    return entry_it == entries_.end() ? std::vector<obs_source_t*>() : entry_it->second.sources;
+}
+
+void BrowserRegistry::OutputVideo(const ChromiumSource* frame, const struct obs_source_frame* video) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    for (const auto& item : entries_) {
+        if (item.second.frame.get() != frame) {
+            continue;
+        }
+        
+        // OBS copies the frame into its own async queue
+        for (obs_source_t* source : item.second.sources) {
+            obs_source_output_video(source, video);
+        }
+        return;
+    }
+}
+
+void BrowserRegistry::LogCounts() const {
+    blog(LOG_INFO, "[Browser Registry] %zu sources served by %zu browsers",
+         keys_.size(), entries_.size());
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <obs-module.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Forward declarations
+class ChromiumSourceImpl;
+struct ChromiumSource;
+
+/**
+ * Identity of the page a source shows. Sources with equal keys render
+ * exactly the same pixels and can share one browser.
+ */
+struct BrowserKey {
+    std::string url;
+    int width;
+    int height;
+    int render_scale;            // percent of the logical size painted
+    bool async;                  // frames go out through obs_source_output_video
+    
+    bool operator<(const BrowserKey& other) const {
+        return std::tie(url, width, height, render_scale, async) <
+               std::tie(other.url, other.width, other.height, other.render_scale, other.async);
+    }
+    
+    bool operator==(const BrowserKey& other) const {
+        return !(*this < other) && !(other < *this);
+    }
+};
+
+/**
+ * Refcounted registry of browsers shared by identical sources. The first
+ * source to join a key owns the browser and paints into the entry's
+ * frame; later sources render the same texture. When the owner leaves,
+ * ownership and the browser pass to the next member. Audio stays per
+ * source, so each keeps its own volume and mute.
+ */
+class BrowserRegistry {
+public:
+    /**
+     * Get the singleton instance of the registry.
+     */
+    static BrowserRegistry* GetInstance();
+    
+    /**
+     * Add a source under a key.
+     * @param owner set to true if the source must create the browser
+     * @return the paint target shared by all members of the key
+     */
+    std::shared_ptr<ChromiumSource> Join(ChromiumSourceImpl* member, const BrowserKey& key,
+                                         obs_source_t* source, bool& owner);
+    
+    /**
+     * Remove a source.
+     * @return the member that inherits the browser if the owner left and
+     *         others remain, otherwise nullptr
+     */
+    ChromiumSourceImpl* Leave(ChromiumSourceImpl* member);
+    
+    /**
+     * Move a source's entry to a new key in place. Only possible when the
+     * source is alone and nobody uses the new key yet, in which case the
+     * browser can simply navigate or resize.
+     */
+    bool Rekey(ChromiumSourceImpl* member, const BrowserKey& key);
+    
+    /**
+     * Have the owner of a source's browser apply its render tier now.
+     * Holding the registry lock keeps the owner from leaving meanwhile.
+     * Called from the member's VideoTick on the graphics thread.
+     */
+    void ApplyOwnerRenderTier(ChromiumSourceImpl* member) const;
+    
+    /**
+     * Number of sources sharing a source's browser, including itself.
+     */
+    size_t GetShareCount(const ChromiumSourceImpl* member) const;
+    
+    /**
+     * Get the OBS sources sharing a source's browser, including its own.
+     */
+    std::vector<obs_source_t*> GetSources(const ChromiumSourceImpl* member) const;
+    
+    /**
+     * Hand a paint to every async source sharing a frame. Holding the
+     * registry lock keeps the sources from leaving mid-output. Called on
+     * CEF threads.
+     */
+    void OutputVideo(const ChromiumSource* frame, const struct obs_source_frame* video) const;
+    
+private:
+    BrowserRegistry();
+    
+    struct Entry {
+        std::shared_ptr<ChromiumSource> frame;
+        std::vector<ChromiumSourceImpl*> members;   // front() owns the browser
+        std::vector<obs_source_t*> sources;
+    };
+    
+    mutable std::mutex mutex_;
+    std::map<BrowserKey, Entry> entries_;
+    std::map<const ChromiumSourceImpl*, BrowserKey> keys_;
+    
+    void LogCounts() const;
+};
@@ -1,8 +1,19 @@
 #include "cef_browser.h"
 #include "chromium_source.h"
+#include "browser_pool.h"
+#include "request_context_policy.h"
+#include "upload_scheduler.h"
+#include "browser_registry.h"
+#include "alert_bridge.h"
+#include "asset_cache.h"
+#include "asset_prefetch.h"
+#include "request_blocker.h"
 #include <include/cef_app.h>
 #include <include/cef_browser.h>
 #include <include/cef_command_line.h>
+#include <include/cef_task.h>
+#include <include/base/cef_callback.h>
+#include <include/wrapper/cef_closure_task.h>
 #include <include/wrapper/cef_helpers.h>
 #include <obs-module.h>
 #include <util/platform.h>
@@ -11,12 +22,18 @@
 #include <QStandardPaths>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+#include <cstdlib>
 
 // Global CEF state
-static bool g_cef_initialized = false;
+static std::atomic<bool> g_cef_initialized{false};
 static CefRefPtr<CEFApp> g_cef_app;
 static std::thread g_message_loop_thread;
-static bool g_shutdown_requested = false;
+static std::atomic<bool> g_shutdown_requested{false};
 
 // CEFApp implementation
 CEFApp::CEFApp() {
@@ -46,12 +63,31 @@ void CEFApp::OnBeforeCommandLineProcessing(const CefString& process_type,
     command_line->AppendSwitch("--disable-web-security");
     command_line->AppendSwitch("--allow-running-insecure-content");
     
+    // Renderer process model for many-source setups
+    if (process_type.empty()) {
+        RequestContextPolicy::GetInstance()->ApplyCommandLine(command_line);
+    }
+    
     blog(LOG_INFO, "[CEF] Applied anti-throttling command line switches");
 }
 
+// FrameTarget implementation
+FrameTarget::FrameTarget(std::shared_ptr<ChromiumSource> frame) : frame_(frame) {
+}
+
+void FrameTarget::Set(std::shared_ptr<ChromiumSource> frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_ = frame;
+}
+
+std::shared_ptr<ChromiumSource> FrameTarget::Lock() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frame_.lock();
+}
+
 // CEFRenderHandler implementation
-CEFRenderHandler::CEFRenderHandler(ChromiumSource* source)
-    : source_(source), width_(DEFAULT_WIDTH), height_(DEFAULT_HEIGHT) {
+CEFRenderHandler::CEFRenderHandler(std::shared_ptr<ChromiumSource> source)
+    : source_(source), width_(DEFAULT_WIDTH), height_(DEFAULT_HEIGHT), scale_(1.0f) {
 }
 
 void CEFRenderHandler::GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect) {
@@ -62,61 +98,51 @@ void CEFRenderHandler::GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect)
     rect.height = height_;
 }
 
+bool CEFRenderHandler::GetScreenInfo(CefRefPtr<CefBrowser> browser, CefScreenInfo& screen_info) {
+    std::lock_guard<std::mutex> lock(size_mutex_);
+    screen_info.device_scale_factor = scale_;
+    screen_info.depth = 32;
+    screen_info.depth_per_component = 8;
+    screen_info.rect = CefRect(0, 0, width_, height_);
+    screen_info.available_rect = screen_info.rect;
+    return true;
+}
+
 void CEFRenderHandler::OnPaint(CefRefPtr<CefBrowser> browser,
                               PaintElementType type,
                               const RectList& dirtyRects,
                               const void* buffer,
                               int width,
                               int height) {
-    if (type != PET_VIEW || !source_ || !buffer) {
+    // Pooled browsers have no source attached; their frames are dropped
+    std::shared_ptr<ChromiumSource> source = source_.Lock();
+    if (type != PET_VIEW || !source || !buffer) {
         return;
     }
     
-    // Update texture with new frame data
-    pthread_mutex_lock(&source_->texture_mutex);
-    
-    obs_enter_graphics();
-    
-    // Create or recreate texture if size changed
-    if (!source_->texture || 
-        gs_texture_get_width(source_->texture) != (uint32_t)width ||
-        gs_texture_get_height(source_->texture) != (uint32_t)height) {
-        
-        if (source_->texture) {
-            gs_texture_destroy(source_->texture);
-        }
-        
-        source_->texture = gs_texture_create(width, height, GS_BGRA, 1, nullptr, GS_DYNAMIC);
-        if (!source_->texture) {
-            blog(LOG_ERROR, "[CEF] Failed to create texture (%dx%d)", width, height);
-            obs_leave_graphics();
-            pthread_mutex_unlock(&source_->texture_mutex);
-            return;
-        }
-    }
-    
-    // Update texture data
-    if (source_->texture) {
-        uint8_t* texture_data;
-        uint32_t linesize;
+    uint64_t now_ns = os_gettime_ns();
+    
+    if (source->async_output) {
+        // OBS buffers, uploads and times the frame on its own
+        struct obs_source_frame frame = {};
+        frame.data[0] = (uint8_t*)buffer;
+        frame.linesize[0] = (uint32_t)width * 4;
+        frame.width = (uint32_t)width;
+        frame.height = (uint32_t)height;
+        frame.format = VIDEO_FORMAT_BGRA;
+        frame.full_range = true;
+        frame.timestamp = now_ns;
         
-        if (gs_texture_map(source_->texture, &texture_data, &linesize)) {
-            // CEF provides BGRA data, which matches OBS expectations
-            const uint8_t* src = static_cast<const uint8_t*>(buffer);
-            const uint32_t src_linesize = width * 4; // 4 bytes per pixel (BGRA)
-            
-            for (int y = 0; y < height; ++y) {
-                memcpy(texture_data + y * linesize, 
-                       src + y * src_linesize, 
-                       src_linesize);
-            }
-            
-            gs_texture_unmap(source_->texture);
+        BrowserRegistry::GetInstance()->OutputVideo(source.get(), &frame);
+        if (source->page_loaded) {
+            source->painted_since_load = true;
         }
+    } else {
+        // Only a CPU copy here; the upload scheduler moves it to the GPU
+        // within the per-frame budget, coalescing paints that arrive faster
+        UploadScheduler::StagePaint(source.get(), buffer, width, height);
     }
-    
-    obs_leave_graphics();
-    pthread_mutex_unlock(&source_->texture_mutex);
+    source->health.RecordPaint(now_ns);
 }
 
 void CEFRenderHandler::SetSize(int width, int height) {
@@ -125,8 +151,17 @@ void CEFRenderHandler::SetSize(int width, int height) {
     height_ = height;
 }
 
+void CEFRenderHandler::SetScale(float scale) {
+    std::lock_guard<std::mutex> lock(size_mutex_);
+    scale_ = scale;
+}
+
+void CEFRenderHandler::SetSource(std::shared_ptr<ChromiumSource> source) {
+    source_.Set(std::move(source));
+}
+
 // CEFLoadHandler implementation
-CEFLoadHandler::CEFLoadHandler(ChromiumSource* source) : source_(source) {
+CEFLoadHandler::CEFLoadHandler(std::shared_ptr<ChromiumSource> source) : source_(source) {
 }
 
 void CEFLoadHandler::OnLoadStart(CefRefPtr<CefBrowser> browser,
@@ -134,6 +169,18 @@ void CEFLoadHandler::OnLoadStart(CefRefPtr<CefBrowser> browser,
                                 TransitionType transition_type) {
     if (frame->IsMain()) {
         blog(LOG_INFO, "[CEF] Started loading: %s", frame->GetURL().ToString().c_str());
+        
+        std::shared_ptr<ChromiumSource> source = source_.Lock();
+        if (source) {
+            source->page_loaded = false;
+            source->painted_since_load = false;
+            source->navigation_ns = os_gettime_ns();
+            source->alerts.Reset();
+            
+            // Before the page's own scripts, so alerts they start while
+            // loading are seen
+            frame->ExecuteJavaScript(AlertBridge::GetShim(), frame->GetURL(), 0);
+        }
     }
 }
 
@@ -144,6 +191,26 @@ void CEFLoadHandler::OnLoadEnd(CefRefPtr<CefBrowser> browser,
         blog(LOG_INFO, "[CEF] Finished loading: %s (Status: %d)", 
              frame->GetURL().ToString().c_str(), httpStatusCode);
         
+        std::shared_ptr<ChromiumSource> source = source_.Lock();
+        if (source) {
+            source->page_loaded = true;
+            source->health.RecordLoadEnd(os_gettime_ns());
+            
+            // Again in case the document was replaced while loading; the
+            // shim does nothing if it is already there
+            frame->ExecuteJavaScript(AlertBridge::GetShim(), frame->GetURL(), 0);
+            
+            int prefetch_mode;
+            std::vector<std::string> manifest;
+            {
+                std::lock_guard<std::mutex> lock(source->prefetch_mutex);
+                prefetch_mode = source->prefetch_mode;
+                manifest = source->prefetch_manifest;
+            }
+            AssetPrefetcher::GetInstance()->Schedule(frame->GetURL().ToString(), prefetch_mode, manifest,
+                                                     browser->GetHost()->GetRequestContext());
+        }
+        
         // Force an initial repaint to ensure content is visible
         browser->GetHost()->Invalidate(PET_VIEW);
     }
@@ -157,11 +224,111 @@ void CEFLoadHandler::OnLoadError(CefRefPtr<CefBrowser> browser,
     if (frame->IsMain()) {
         blog(LOG_WARNING, "[CEF] Load error: %s (Code: %d, URL: %s)", 
              errorText.ToString().c_str(), errorCode, failedUrl.ToString().c_str());
+        
+        // Aborted navigations are expected when the URL changes mid-load
+        std::shared_ptr<ChromiumSource> source = source_.Lock();
+        if (source && errorCode != ERR_ABORTED) {
+            source->health.RecordLoadError(os_gettime_ns());
+        }
     }
 }
 
+void CEFLoadHandler::SetSource(std::shared_ptr<ChromiumSource> source) {
+    source_.Set(std::move(source));
+}
+
+// CEFDisplayHandler implementation
+CEFDisplayHandler::CEFDisplayHandler(std::shared_ptr<ChromiumSource> source) : source_(source) {
+}
+
+bool CEFDisplayHandler::OnConsoleMessage(CefRefPtr<CefBrowser> browser,
+                                        cef_log_severity_t level,
+                                        const CefString& message,
+                                        const CefString& source,
+                                        int line) {
+    static const size_t prefix_len = strlen(HEALTH_HEARTBEAT_PREFIX);
+    static const size_t alert_prefix_len = strlen(ALERT_BRIDGE_PREFIX);
+    
+    std::string text = message.ToString();
+    if (text.compare(0, alert_prefix_len, ALERT_BRIDGE_PREFIX) == 0) {
+        std::shared_ptr<ChromiumSource> target = source_.Lock();
+        if (target && target->alerts.HandleMessage(text.substr(alert_prefix_len), os_gettime_ns()) &&
+            target->showing_refs + target->program_refs > 0) {
+            // Raise the frame rate on the alert's first frame; the owning
+            // source settles the tier on its next tick
+            CefRefPtr<CefBrowserHost> host = browser->GetHost();
+            host->SetWindowlessFrameRate(RENDER_FPS_PROGRAM);
+            host->Invalidate(PET_VIEW);
+        }
+        return true;
+    }
+    
+    if (text.compare(0, prefix_len, HEALTH_HEARTBEAT_PREFIX) != 0) {
+        return false;
+    }
+    
+    std::shared_ptr<ChromiumSource> target = source_.Lock();
+    if (target) {
+        uint32_t seq = (uint32_t)strtoul(text.c_str() + prefix_len, nullptr, 10);
+        target->health.RecordHeartbeatAck(seq, os_gettime_ns());
+    }
+    
+    // Keep heartbeats out of the console log
+    return true;
+}
+
+void CEFDisplayHandler::SetSource(std::shared_ptr<ChromiumSource> source) {
+    source_.Set(std::move(source));
+}
+
+// CEFRequestHandler implementation
+CEFRequestHandler::CEFRequestHandler(std::shared_ptr<ChromiumSource> source) : source_(source) {
+}
+
+void CEFRequestHandler::OnRenderProcessTerminated(CefRefPtr<CefBrowser> browser,
+                                                  TerminationStatus status) {
+    blog(LOG_WARNING, "[CEF] Renderer process terminated (status: %d)", status);
+    
+    // The owning source respawns the browser from its next VideoTick
+    std::shared_ptr<ChromiumSource> source = source_.Lock();
+    if (source) {
+        source->health.RecordRendererTerminated();
+        source->renderer_crashed = true;
+    }
+}
+
+CefRefPtr<CefResourceRequestHandler> CEFRequestHandler::GetResourceRequestHandler(CefRefPtr<CefBrowser> browser,
+                                                                                  CefRefPtr<CefFrame> frame,
+                                                                                  CefRefPtr<CefRequest> request,
+                                                                                  bool is_navigation,
+                                                                                  bool is_download,
+                                                                                  const CefString& request_initiator,
+                                                                                  bool& disable_default_handling) {
+    // Trackers and analytics never leave the browser; the page itself is
+    // always loaded
+    uint32_t cost_us = 0;
+    if (!(is_navigation && frame && frame->IsMain()) && RequestBlocker::GetInstance()->Check(request, cost_us)) {
+        std::shared_ptr<ChromiumSource> source = source_.Lock();
+        if (source) {
+            source->blocked_requests++;
+            source->blocked_cost_us += cost_us;
+        }
+        return RequestBlocker::GetInstance()->GetBlockingHandler();
+    }
+    
+    // Alert media is served from the local asset cache when it can be; the
+    // page URL lets the prefetcher learn what each overlay loads
+    std::string page_url = browser ? browser->GetMainFrame()->GetURL().ToString() : std::string();
+    return AssetCache::GetInstance()->GetRequestHandler(request, page_url);
+}
+
+void CEFRequestHandler::SetSource(std::shared_ptr<ChromiumSource> source) {
+    source_.Set(std::move(source));
+}
+
 // CEFLifeSpanHandler implementation
-CEFLifeSpanHandler::CEFLifeSpanHandler(ChromiumSource* source) : source_(source) {
+CEFLifeSpanHandler::CEFLifeSpanHandler(std::shared_ptr<ChromiumSource> source)
+    : source_(source), create_failed_(false), detached_(false) {
 }
 
 bool CEFLifeSpanHandler::OnBeforePopup(CefRefPtr<CefBrowser> browser,
@@ -182,6 +349,26 @@ bool CEFLifeSpanHandler::OnBeforePopup(CefRefPtr<CefBrowser> browser,
 }
 
 void CEFLifeSpanHandler::OnAfterCreated(CefRefPtr<CefBrowser> browser) {
+    bool detached;
+    std::string pending_url;
+    {
+        std::lock_guard<std::mutex> lock(browser_mutex_);
+        detached = detached_;
+        if (!detached) {
+            browser_ = browser;
+            pending_url.swap(pending_url_);
+        }
+    }
+    
+    // Its owner gave up on it while CEF was still creating it
+    if (detached) {
+        browser->GetHost()->CloseBrowser(true);
+        return;
+    }
+    
+    if (!pending_url.empty()) {
+        browser->GetMainFrame()->LoadURL(pending_url);
+    }
     blog(LOG_INFO, "[CEF] Browser created successfully");
 }
 
@@ -189,16 +376,58 @@ void CEFLifeSpanHandler::OnBeforeClose(CefRefPtr<CefBrowser> browser) {
     blog(LOG_INFO, "[CEF] Browser closing");
 }
 
+void CEFLifeSpanHandler::SetSource(std::shared_ptr<ChromiumSource> source) {
+    source_.Set(std::move(source));
+}
+
+CefRefPtr<CefBrowser> CEFLifeSpanHandler::GetBrowser() const {
+    std::lock_guard<std::mutex> lock(browser_mutex_);
+    return browser_;
+}
+
+void CEFLifeSpanHandler::SetCreateFailed() {
+    std::lock_guard<std::mutex> lock(browser_mutex_);
+    create_failed_ = true;
+}
+
+bool CEFLifeSpanHandler::HasCreateFailed() const {
+    std::lock_guard<std::mutex> lock(browser_mutex_);
+    return create_failed_;
+}
+
+void CEFLifeSpanHandler::SetPendingURL(const std::string& url) {
+    std::lock_guard<std::mutex> lock(browser_mutex_);
+    pending_url_ = url;
+}
+
+CefRefPtr<CefBrowser> CEFLifeSpanHandler::Detach() {
+    std::lock_guard<std::mutex> lock(browser_mutex_);
+    detached_ = true;
+    CefRefPtr<CefBrowser> browser = browser_;
+    browser_ = nullptr;
+    return browser;
+}
+
 // CEFClient implementation
-CEFClient::CEFClient(ChromiumSource* source) : source_(source) {
+CEFClient::CEFClient(std::shared_ptr<ChromiumSource> source) {
     render_handler_ = new CEFRenderHandler(source);
     load_handler_ = new CEFLoadHandler(source);
     life_span_handler_ = new CEFLifeSpanHandler(source);
+    display_handler_ = new CEFDisplayHandler(source);
+    request_handler_ = new CEFRequestHandler(source);
+}
+
+void CEFClient::SetSource(std::shared_ptr<ChromiumSource> source) {
+    render_handler_->SetSource(source);
+    load_handler_->SetSource(source);
+    life_span_handler_->SetSource(source);
+    display_handler_->SetSource(source);
+    request_handler_->SetSource(source);
 }
 
 // CEFBrowser implementation
-CEFBrowser::CEFBrowser(ChromiumSource* source) 
-    : source_(source), initialized_(false) {
+CEFBrowser::CEFBrowser(std::shared_ptr<ChromiumSource> source) 
+    : initialized_(false), tier_(RenderTier::Program) {
     client_ = new CEFClient(source);
 }
 
@@ -220,30 +449,59 @@ bool CEFBrowser::Initialize(const std::string& url, int width, int height) {
     CefBrowserSettings browser_settings;
     ConfigureBrowserSettings(browser_settings);
     
-    // Configure window info for off-screen rendering
-    CefWindowInfo window_info;
-    window_info.SetAsWindowless(nullptr);
-    
     // Update render handler size
     client_->GetCEFRenderHandler()->SetSize(width, height);
     
-    // Create the browser
-    browser_ = CefBrowserHost::CreateBrowserSync(
-        window_info, client_, url, browser_settings, nullptr, nullptr);
-    
-    if (!browser_) {
-        blog(LOG_ERROR, "[CEF] Failed to create browser");
-        return false;
+    // CreateBrowserSync only works on the CEF UI thread, the private CEF
+    // thread. Callers elsewhere are OBS threads that must not wait for it,
+    // so the creation is posted and the browser picked up when it exists.
+    if (!CefCurrentlyOn(TID_UI)) {
+        if (!CefPostTask(TID_UI, base::BindOnce(&CEFBrowser::CreateOnUIThread, client_, url,
+                                                browser_settings))) {
+            blog(LOG_ERROR, "[CEF] Cannot create browser: CEF UI thread is gone");
+            return false;
+        }
+    } else {
+        // Configure window info for off-screen rendering
+        CefWindowInfo window_info;
+        window_info.SetAsWindowless(nullptr);
+        
+        // Create the browser
+        browser_ = CefBrowserHost::CreateBrowserSync(
+            window_info, client_, url, browser_settings, nullptr, nullptr);
+        
+        if (!browser_) {
+            blog(LOG_ERROR, "[CEF] Failed to create browser");
+            return false;
+        }
     }
     
     current_url_ = url;
+    tier_ = RenderTier::Program;
     initialized_ = true;
     
     blog(LOG_INFO, "[CEF] Browser initialized successfully with URL: %s", url.c_str());
     return true;
 }
 
+void CEFBrowser::CreateOnUIThread(CefRefPtr<CEFClient> client, std::string url,
+                                  CefBrowserSettings settings) {
+    CefWindowInfo window_info;
+    window_info.SetAsWindowless(nullptr);
+    
+    // The browser arrives in CEFLifeSpanHandler::OnAfterCreated
+    if (!CefBrowserHost::CreateBrowser(window_info, client, url, settings, nullptr, nullptr)) {
+        blog(LOG_ERROR, "[CEF] Failed to create browser");
+        client->GetCEFLifeSpanHandler()->SetCreateFailed();
+    }
+}
+
 void CEFBrowser::LoadURL(const std::string& url) {
+    if (IsCreating()) {
+        client_->GetCEFLifeSpanHandler()->SetPendingURL(url);
+        current_url_ = url;
+        return;
+    }
     if (!IsValid()) {
         return;
     }
@@ -263,17 +521,48 @@ void CEFBrowser::Reload() {
 }
 
 void CEFBrowser::Resize(int width, int height) {
+    // A browser still being created asks for the size when it starts
+    client_->GetCEFRenderHandler()->SetSize(width, height);
     if (!IsValid()) {
         return;
     }
     
-    client_->GetCEFRenderHandler()->SetSize(width, height);
     browser_->GetHost()->WasResized();
     browser_->GetHost()->Invalidate(PET_VIEW);
 }
 
+void CEFBrowser::SetDeviceScale(float scale) {
+    client_->GetCEFRenderHandler()->SetScale(scale);
+    if (!IsValid()) {
+        return;
+    }
+    
+    CefRefPtr<CefBrowserHost> host = browser_->GetHost();
+    host->NotifyScreenInfoChanged();
+    host->WasResized();
+    host->Invalidate(PET_VIEW);
+}
+
 bool CEFBrowser::IsValid() const {
-    return initialized_ && browser_ && !browser_->GetHost()->IsWindowRenderingDisabled();
+    // Every browser here is windowless, so IsWindowRenderingDisabled() is
+    // always true and says nothing about validity
+    CefRefPtr<CefBrowser> browser = GetBrowser();
+    return initialized_ && browser && browser->IsValid();
+}
+
+bool CEFBrowser::IsCreating() const {
+    return initialized_ && !GetBrowser() && !client_->GetCEFLifeSpanHandler()->HasCreateFailed();
+}
+
+bool CEFBrowser::HasCreateFailed() const {
+    return initialized_ && client_->GetCEFLifeSpanHandler()->HasCreateFailed();
+}
+
+CefRefPtr<CefBrowser> CEFBrowser::GetBrowser() const {
+    if (!browser_ && initialized_) {
+        browser_ = client_->GetCEFLifeSpanHandler()->GetBrowser();
+    }
+    return browser_;
 }
 
 std::string CEFBrowser::GetURL() const {
@@ -289,7 +578,46 @@ void CEFBrowser::Invalidate() {
     }
 }
 
+void CEFBrowser::ExecuteJavaScript(const std::string& code) {
+    if (IsValid()) {
+        CefRefPtr<CefFrame> frame = browser_->GetMainFrame();
+        frame->ExecuteJavaScript(code, frame->GetURL(), 0);
+    }
+}
+
+void CEFBrowser::SetRenderTier(RenderTier tier) {
+    if (!IsValid() || tier == tier_) {
+        return;
+    }
+    
+    CefRefPtr<CefBrowserHost> host = browser_->GetHost();
+    if (tier == RenderTier::Hidden) {
+        // Timers keep running thanks to the anti-throttling switches
+        host->WasHidden(true);
+    } else {
+        host->SetWindowlessFrameRate(tier == RenderTier::Program ? RENDER_FPS_PROGRAM :
+                                     tier == RenderTier::Preview ? RENDER_FPS_PREVIEW : RENDER_FPS_IDLE);
+        if (tier_ == RenderTier::Hidden) {
+            host->WasHidden(false);
+        }
+        
+        // Paint the current page state now rather than on its next change
+        host->Invalidate(PET_VIEW);
+    }
+    
+    tier_ = tier;
+}
+
+RenderTier CEFBrowser::GetRenderTier() const {
+    return tier_;
+}
+
 void CEFBrowser::Close() {
+    // Also closes a browser CEF is still creating, once it arrives
+    CefRefPtr<CefBrowser> created = client_->GetCEFLifeSpanHandler()->Detach();
+    if (!browser_) {
+        browser_ = created;
+    }
     if (browser_) {
         browser_->GetHost()->CloseBrowser(true);
         browser_ = nullptr;
@@ -297,6 +625,10 @@ void CEFBrowser::Close() {
     initialized_ = false;
 }
 
+void CEFBrowser::SetSource(std::shared_ptr<ChromiumSource> source) {
+    client_->SetSource(std::move(source));
+}
+
 void CEFBrowser::ConfigureBrowserSettings(CefBrowserSettings& settings) {
     // Enable web security
     settings.web_security = STATE_DISABLED;
@@ -313,15 +645,83 @@ void CEFBrowser::ConfigureBrowserSettings(CefBrowserSettings& settings) {
     settings.background_color = CefColorSetARGB(0, 0, 0, 0);
     
     // Frame rate
-    settings.windowless_frame_rate = 60;
+    settings.windowless_frame_rate = RENDER_FPS_PROGRAM;
 }
 
 // CEFManager implementation
 namespace CEFManager {
+
+// Bring-up state shared between OBS threads and the CEF thread
+enum class State {
+    Stopped,
+    Starting,
+    Ready,
+    Failed
+};
+
+static std::mutex g_state_mutex;
+static std::condition_variable g_state_cv;
+static State g_state = State::Stopped;
+
+static void SetState(State state) {
+    {
+        std::lock_guard<std::mutex> lock(g_state_mutex);
+        g_state = state;
+        g_cef_initialized = (state == State::Ready);
+    }
+    g_state_cv.notify_all();
+}
+
+/**
+ * Body of the CEF thread. CefInitialize, CefDoMessageLoopWork and CefShutdown
+ * must all run on the same thread when the multi-threaded message loop is off,
+ * so the whole CEF lifetime lives here.
+ */
+static void RunCEFThread(CefSettings settings) {
+    blog(LOG_INFO, "[CEF] Message loop thread started");
     
-bool Initialize() {
-    if (g_cef_initialized) {
-        return true;
+    uint64_t start_ns = os_gettime_ns();
+    CefMainArgs main_args;
+    
+    if (!CefInitialize(main_args, settings, g_cef_app, nullptr)) {
+        blog(LOG_ERROR, "[CEF] Failed to initialize CEF");
+        SetState(State::Failed);
+        return;
+    }
+    
+    SetState(State::Ready);
+    blog(LOG_INFO, "[CEF] CEF framework initialized successfully (%.1f ms)",
+         (os_gettime_ns() - start_ns) / 1000000.0);
+    
+    // Warm the browser pool now that browsers can be created
+    obs_data_t* config = ChromiumPlugin::GetInstance()->GetConfig();
+    BrowserPool::GetInstance()->Configure(
+        (size_t)std::max<long long>(0, obs_data_get_int(config, CONFIG_POOL_SIZE)),
+        DEFAULT_WIDTH, DEFAULT_HEIGHT);
+    BrowserPool::GetInstance()->Refill();
+    
+    while (!g_shutdown_requested) {
+        CefDoMessageLoopWork();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    
+    // Shutdown CEF on the thread that initialized it
+    CefShutdown();
+    SetState(State::Stopped);
+    
+    blog(LOG_INFO, "[CEF] Message loop thread ended");
+}
+
+bool InitializeAsync() {
+    {
+        std::lock_guard<std::mutex> lock(g_state_mutex);
+        if (g_state == State::Starting || g_state == State::Ready) {
+            return true;
+        }
+        if (g_state == State::Failed) {
+            return false;
+        }
+        g_state = State::Starting;
     }
     
     blog(LOG_INFO, "[CEF] Initializing CEF framework");
@@ -330,9 +730,6 @@ bool Initialize() {
     QString app_path = QApplication::applicationDirPath();
     QString cef_path = app_path + "/cef";
     
-    // CEF main arguments
-    CefMainArgs main_args;
-    
     // CEF settings
     CefSettings settings;
     settings.no_sandbox = true;
@@ -356,40 +753,44 @@ bool Initialize() {
     
     // Create CEF app
     g_cef_app = new CEFApp();
+    g_shutdown_requested = false;
     
-    // Initialize CEF
-    if (!CefInitialize(main_args, settings, g_cef_app, nullptr)) {
-        blog(LOG_ERROR, "[CEF] Failed to initialize CEF");
+    // CefInitialize runs on the message loop thread so the caller never blocks
+    g_message_loop_thread = std::thread(RunCEFThread, settings);
+    return true;
+}
+
+bool Initialize() {
+    if (!InitializeAsync()) {
         return false;
     }
+    return WaitForInitialization(0);
+}
+
+bool WaitForInitialization(uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(g_state_mutex);
+    auto done = []() { return g_state != State::Starting; };
     
-    g_cef_initialized = true;
-    g_shutdown_requested = false;
-    
-    // Start message loop thread
-    g_message_loop_thread = std::thread([]() {
-        blog(LOG_INFO, "[CEF] Message loop thread started");
-        
-        while (!g_shutdown_requested) {
-            CefDoMessageLoopWork();
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
-        
-        blog(LOG_INFO, "[CEF] Message loop thread ended");
-    });
+    if (timeout_ms == 0) {
+        g_state_cv.wait(lock, done);
+    } else if (!g_state_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), done)) {
+        return false;
+    }
     
-    blog(LOG_INFO, "[CEF] CEF framework initialized successfully");
-    return true;
+    return g_state == State::Ready;
 }
 
 void Shutdown() {
-    if (!g_cef_initialized) {
-        return;
+    {
+        std::lock_guard<std::mutex> lock(g_state_mutex);
+        if (g_state == State::Stopped && !g_message_loop_thread.joinable()) {
+            return;
+        }
     }
     
     blog(LOG_INFO, "[CEF] Shutting down CEF framework");
     
-    // Signal shutdown
+    // Signal shutdown; the CEF thread calls CefShutdown before exiting
     g_shutdown_requested = true;
     
     // Wait for message loop thread to finish
@@ -397,10 +798,7 @@ void Shutdown() {
         g_message_loop_thread.join();
     }
     
-    // Shutdown CEF
-    CefShutdown();
-    
-    g_cef_initialized = false;
+    SetState(State::Stopped);
     g_cef_app = nullptr;
     
     blog(LOG_INFO, "[CEF] CEF framework shut down successfully");
@@ -416,4 +814,9 @@ bool IsInitialized() {
     return g_cef_initialized;
 }
 
+bool HasFailed() {
+    std::lock_guard<std::mutex> lock(g_state_mutex);
+    return g_state == State::Failed;
+}
+
 } // namespace CEFManager
\ No newline at end of file
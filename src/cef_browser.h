@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <atomic>
 
 // Forward declaration
 struct ChromiumSource;
@@ -37,21 +38,46 @@ public:
     void OnContextInitialized() override;
     void OnBeforeCommandLineProcessing(const CefString& process_type,
                                      CefRefPtr<CefCommandLine> command_line) override;
-    
+                                     
 private:
     IMPLEMENT_REFCOUNTING(CEFApp);
 };
 
+/**
+ * Frame a CEF handler reports to. Handlers only hold it weakly and lock it
+ * for the duration of each callback, so a source dropping the frame while
+ * a callback runs on a CEF thread frees it once that callback returns.
+ */
+class FrameTarget {
+public:
+    explicit FrameTarget(std::shared_ptr<ChromiumSource> frame);
+    
+    /**
+     * Change the frame (nullptr detaches).
+     */
+    void Set(std::shared_ptr<ChromiumSource> frame);
+    
+    /**
+     * Get the frame for use in a callback; nullptr if detached or freed.
+     */
+    std::shared_ptr<ChromiumSource> Lock() const;
+    
+private:
+    mutable std::mutex mutex_;
+    std::weak_ptr<ChromiumSource> frame_;
+};
+
 /**
  * CEF Render Handler that manages off-screen rendering.
  * This class receives painted frames from CEF and converts them to OBS textures.
  */
 class CEFRenderHandler : public CefRenderHandler {
 public:
-    explicit CEFRenderHandler(ChromiumSource* source);
+    explicit CEFRenderHandler(std::shared_ptr<ChromiumSource> source);
     
     // CefRenderHandler methods
     void GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect) override;
+    bool GetScreenInfo(CefRefPtr<CefBrowser> browser, CefScreenInfo& screen_info) override;
     void OnPaint(CefRefPtr<CefBrowser> browser,
                 PaintElementType type,
                 const RectList& dirtyRects,
@@ -64,10 +90,22 @@ public:
      */
     void SetSize(int width, int height);
     
+    /**
+     * Set the device scale factor. The view keeps its logical size, so the
+     * layout is unchanged while painted frames are scaled by the factor.
+     */
+    void SetScale(float scale);
+    
+    /**
+     * Change the source that receives painted frames (nullptr discards them).
+     */
+    void SetSource(std::shared_ptr<ChromiumSource> source);
+    
 private:
-    ChromiumSource* source_;
+    FrameTarget source_;
     int width_;
     int height_;
+    float scale_;
     std::mutex size_mutex_;
     
     IMPLEMENT_REFCOUNTING(CEFRenderHandler);
@@ -78,7 +116,7 @@ private:
  */
 class CEFLoadHandler : public CefLoadHandler {
 public:
-    explicit CEFLoadHandler(ChromiumSource* source);
+    explicit CEFLoadHandler(std::shared_ptr<ChromiumSource> source);
     
     // CefLoadHandler methods
     void OnLoadStart(CefRefPtr<CefBrowser> browser,
@@ -93,18 +131,79 @@ public:
                     const CefString& errorText,
                     const CefString& failedUrl) override;
     
+    /**
+     * Change the source that receives load events.
+     */
+    void SetSource(std::shared_ptr<ChromiumSource> source);
+    
 private:
-    ChromiumSource* source_;
+    FrameTarget source_;
     
     IMPLEMENT_REFCOUNTING(CEFLoadHandler);
 };
 
+/**
+ * CEF Display Handler that watches console output for health heartbeats
+ * and alert bridge messages.
+ */
+class CEFDisplayHandler : public CefDisplayHandler {
+public:
+    explicit CEFDisplayHandler(std::shared_ptr<ChromiumSource> source);
+    
+    // CefDisplayHandler methods
+    bool OnConsoleMessage(CefRefPtr<CefBrowser> browser,
+                         cef_log_severity_t level,
+                         const CefString& message,
+                         const CefString& source,
+                         int line) override;
+    
+    /**
+     * Change the source that receives heartbeat acknowledgements.
+     */
+    void SetSource(std::shared_ptr<ChromiumSource> source);
+    
+private:
+    FrameTarget source_;
+    
+    IMPLEMENT_REFCOUNTING(CEFDisplayHandler);
+};
+
+/**
+ * CEF Request Handler that reports renderer process failures.
+ */
+class CEFRequestHandler : public CefRequestHandler {
+public:
+    explicit CEFRequestHandler(std::shared_ptr<ChromiumSource> source);
+    
+    // CefRequestHandler methods
+    void OnRenderProcessTerminated(CefRefPtr<CefBrowser> browser,
+                                   TerminationStatus status) override;
+    
+    CefRefPtr<CefResourceRequestHandler> GetResourceRequestHandler(CefRefPtr<CefBrowser> browser,
+                                                                   CefRefPtr<CefFrame> frame,
+                                                                   CefRefPtr<CefRequest> request,
+                                                                   bool is_navigation,
+                                                                   bool is_download,
+                                                                   const CefString& request_initiator,
+                                                                   bool& disable_default_handling) override;
+    
+    /**
+     * Change the source that receives termination events.
+     */
+    void SetSource(std::shared_ptr<ChromiumSource> source);
+    
+private:
+    FrameTarget source_;
+    
+    IMPLEMENT_REFCOUNTING(CEFRequestHandler);
+};
+
 /**
  * CEF Life Span Handler that manages browser lifecycle events.
  */
 class CEFLifeSpanHandler : public CefLifeSpanHandler {
 public:
-    explicit CEFLifeSpanHandler(ChromiumSource* source);
+    explicit CEFLifeSpanHandler(std::shared_ptr<ChromiumSource> source);
     
     // CefLifeSpanHandler methods
     bool OnBeforePopup(CefRefPtr<CefBrowser> browser,
@@ -123,8 +222,47 @@ public:
     void OnAfterCreated(CefRefPtr<CefBrowser> browser) override;
     void OnBeforeClose(CefRefPtr<CefBrowser> browser) override;
     
+    /**
+     * Change the source that receives lifecycle events.
+     */
+    void SetSource(std::shared_ptr<ChromiumSource> source);
+    
+    /**
+     * Get the browser once CEF has reported it created.
+     */
+    CefRefPtr<CefBrowser> GetBrowser() const;
+    
+    /**
+     * Record that an asynchronous creation failed.
+     */
+    void SetCreateFailed();
+    
+    /**
+     * Check whether an asynchronous creation failed.
+     */
+    bool HasCreateFailed() const;
+    
+    /**
+     * Navigate to a URL as soon as the browser exists.
+     */
+    void SetPendingURL(const std::string& url);
+    
+    /**
+     * Let go of the browser. One still being created is closed as soon as
+     * CEF reports it.
+     * @return the browser if it already exists
+     */
+    CefRefPtr<CefBrowser> Detach();
+    
 private:
-    ChromiumSource* source_;
+    FrameTarget source_;
+    
+    // Written on the CEF UI thread, read from OBS threads
+    mutable std::mutex browser_mutex_;
+    CefRefPtr<CefBrowser> browser_;
+    std::string pending_url_;
+    bool create_failed_;
+    bool detached_;
     
     IMPLEMENT_REFCOUNTING(CEFLifeSpanHandler);
 };
@@ -134,7 +272,7 @@ private:
  */
 class CEFClient : public CefClient {
 public:
-    explicit CEFClient(ChromiumSource* source);
+    explicit CEFClient(std::shared_ptr<ChromiumSource> source);
     
     // CefClient methods
     CefRefPtr<CefRenderHandler> GetRenderHandler() override {
@@ -149,6 +287,14 @@ public:
         return life_span_handler_;
     }
     
+    CefRefPtr<CefDisplayHandler> GetDisplayHandler() override {
+        return display_handler_;
+    }
+    
+    CefRefPtr<CefRequestHandler> GetRequestHandler() override {
+        return request_handler_;
+    }
+    
     /**
      * Get the render handler for external access.
      */
@@ -156,26 +302,54 @@ public:
         return render_handler_;
     }
     
+    /**
+     * Get the life span handler, which receives the created browser.
+     */
+    CefRefPtr<CEFLifeSpanHandler> GetCEFLifeSpanHandler() {
+        return life_span_handler_;
+    }
+    
+    /**
+     * Retarget all handlers to a different source.
+     */
+    void SetSource(std::shared_ptr<ChromiumSource> source);
+    
 private:
-    ChromiumSource* source_;
     CefRefPtr<CEFRenderHandler> render_handler_;
     CefRefPtr<CEFLoadHandler> load_handler_;
     CefRefPtr<CEFLifeSpanHandler> life_span_handler_;
+    CefRefPtr<CEFDisplayHandler> display_handler_;
+    CefRefPtr<CEFRequestHandler> request_handler_;
     
     IMPLEMENT_REFCOUNTING(CEFClient);
 };
 
+/**
+ * How much rendering a browser gets, from where its sources are shown.
+ */
+enum class RenderTier {
+    Hidden,    // JS keeps running, painting is suspended
+    Idle,      // page reports no alert playing, minimal frame rate
+    Preview,   // shown only in preview, reduced frame rate
+    Program    // on air, full frame rate
+};
+
 /**
  * Main CEF Browser wrapper class that manages a single browser instance.
  * This class handles browser creation, navigation, and cleanup.
  */
 class CEFBrowser {
 public:
-    explicit CEFBrowser(ChromiumSource* source);
+    explicit CEFBrowser(std::shared_ptr<ChromiumSource> source);
     ~CEFBrowser();
     
     /**
-     * Initialize the browser with the specified URL and dimensions.
+     * Initialize the browser with the specified URL and dimensions. On the
+     * CEF UI thread the browser is created before this returns. Anywhere
+     * else the creation is posted there and this returns at once; the
+     * browser becomes valid when CEF has created it, see IsCreating().
+     * Calls made meanwhile are kept until then, or repeated by the caller.
+     * @return false if the browser could not be created or posted
      */
     bool Initialize(const std::string& url, int width, int height);
     
@@ -194,11 +368,26 @@ public:
      */
     void Resize(int width, int height);
     
+    /**
+     * Paint at a fraction of the logical size (see CEFRenderHandler::SetScale).
+     */
+    void SetDeviceScale(float scale);
+    
     /**
      * Check if the browser is valid and ready.
      */
     bool IsValid() const;
     
+    /**
+     * Check if an asynchronous creation is still waiting for CEF.
+     */
+    bool IsCreating() const;
+    
+    /**
+     * Check if CEF failed an asynchronous creation.
+     */
+    bool HasCreateFailed() const;
+    
     /**
      * Get the current URL.
      */
@@ -209,20 +398,52 @@ public:
      */
     void Invalidate();
     
+    /**
+     * Run a script in the main frame.
+     */
+    void ExecuteJavaScript(const std::string& code);
+    
+    /**
+     * Switch rendering tier. Takes effect immediately; a browser becoming
+     * visible is invalidated so it paints without waiting for the page.
+     */
+    void SetRenderTier(RenderTier tier);
+    
+    /**
+     * Get the current rendering tier.
+     */
+    RenderTier GetRenderTier() const;
+    
     /**
      * Cleanup and close the browser.
      */
     void Close();
     
+    /**
+     * Attach the browser to a source so painted frames land in its texture.
+     * Pass nullptr to detach, e.g. while the browser is parked in the pool.
+     * The browser does not keep the frame alive.
+     */
+    void SetSource(std::shared_ptr<ChromiumSource> source);
+    
 private:
-    ChromiumSource* source_;
-    CefRefPtr<CefBrowser> browser_;
+    // Picked up from the life span handler once CEF has created the browser
+    mutable CefRefPtr<CefBrowser> browser_;
     CefRefPtr<CEFClient> client_;
     bool initialized_;
     std::string current_url_;
+    RenderTier tier_;
     
     // Browser settings
     void ConfigureBrowserSettings(CefBrowserSettings& settings);
+    
+    // The browser, if CEF has created it yet
+    CefRefPtr<CefBrowser> GetBrowser() const;
+    
+    // Asynchronous creation, run as a task on the CEF UI thread. Only
+    // refcounted state is bound, so the CEFBrowser may be gone by then.
+    static void CreateOnUIThread(CefRefPtr<CEFClient> client, std::string url,
+                                 CefBrowserSettings settings);
 };
 
 /**
@@ -230,10 +451,25 @@ private:
  */
 namespace CEFManager {
     /**
-     * Initialize the CEF framework with anti-throttling settings.
+     * Start bringing up the CEF framework on its own thread and return
+     * immediately. Safe to call repeatedly; only the first call does work.
+     * @return false if a previous initialization attempt failed
+     */
+    bool InitializeAsync();
+    
+    /**
+     * Initialize the CEF framework with anti-throttling settings and
+     * block until it is ready.
      */
     bool Initialize();
     
+    /**
+     * Wait for a pending initialization to finish.
+     * @param timeout_ms maximum time to wait, 0 waits indefinitely
+     * @return true if CEF is ready
+     */
+    bool WaitForInitialization(uint32_t timeout_ms);
+    
     /**
      * Shutdown the CEF framework and cleanup resources.
      */
@@ -248,4 +484,16 @@ namespace CEFManager {
      * Check if CEF is initialized.
      */
     bool IsInitialized();
-}
\ No newline at end of file
+    
+    /**
+     * Check if CEF initialization was attempted and failed.
+     */
+    bool HasFailed();
+}
+
+/**
+ * Windowless frame rates per rendering tier.
+ */
+#define RENDER_FPS_PROGRAM 60
+#define RENDER_FPS_PREVIEW 15
+#define RENDER_FPS_IDLE 5
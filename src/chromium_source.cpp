@@ -1,12 +1,26 @@
 #include "chromium_source.h"
 #include "cef_browser.h"
 #include "cef_audio.h"
+#include "browser_pool.h"
+#include "memory_watchdog.h"
+#include "upload_scheduler.h"
+#include "texture_pool.h"
+#include "frame_snapshot.h"
+#include "asset_cache.h"
+#include "region_view_source.h"
 #include <obs-module.h>
 #include <obs-properties.h>
 #include <graphics/graphics.h>
+#include <graphics/vec2.h>
+#include <graphics/vec4.h>
 #include <util/platform.h>
+#include <util/profiler.h>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+
+// Render-thread cost of the synchronous source in the OBS profiler
+static const char* video_render_name = "chromium_source_render";
 
 // OBS source callbacks implementation
 void* chromium_source_create(obs_data_t* settings, obs_source_t* source) {
@@ -51,6 +65,34 @@ void chromium_source_video_render(void* data, gs_effect_t* effect) {
     impl->VideoRender(effect);
 }
 
+void chromium_source_activate(void* data) {
+    if (!data) return;
+    
+    ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(data);
+    impl->Activate();
+}
+
+void chromium_source_deactivate(void* data) {
+    if (!data) return;
+    
+    ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(data);
+    impl->Deactivate();
+}
+
+void chromium_source_show(void* data) {
+    if (!data) return;
+    
+    ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(data);
+    impl->Show();
+}
+
+void chromium_source_hide(void* data) {
+    if (!data) return;
+    
+    ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(data);
+    impl->Hide();
+}
+
 uint32_t chromium_source_get_width(void* data) {
     if (!data) return 0;
     
@@ -98,6 +140,50 @@ obs_properties_t* chromium_source_get_properties(void* data) {
     obs_property_t* continuous_prop = obs_properties_add_bool(props, PROP_FORCE_CONTINUOUS, TEXT_FORCE_CONTINUOUS);
     obs_property_set_long_description(continuous_prop, TEXT_FORCE_CONTINUOUS_TOOLTIP);
     
+    // Alert bridge idle rate on Program
+    obs_property_t* idle_prop = obs_properties_add_bool(props, PROP_IDLE_ON_PROGRAM, TEXT_IDLE_ON_PROGRAM);
+    obs_property_set_long_description(idle_prop, TEXT_IDLE_ON_PROGRAM_TOOLTIP);
+    
+    // Auto resolution
+    obs_property_t* auto_res_prop = obs_properties_add_bool(props, PROP_AUTO_RESOLUTION, TEXT_AUTO_RESOLUTION);
+    obs_property_set_long_description(auto_res_prop, TEXT_AUTO_RESOLUTION_TOOLTIP);
+    
+    // Render scale and the filter that scales it back up
+    obs_property_t* scale_prop = obs_properties_add_list(props, PROP_RENDER_SCALE, TEXT_RENDER_SCALE, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_set_long_description(scale_prop, TEXT_RENDER_SCALE_TOOLTIP);
+    obs_property_list_add_int(scale_prop, "100%", 100);
+    obs_property_list_add_int(scale_prop, "75%", 75);
+    obs_property_list_add_int(scale_prop, "50%", 50);
+    obs_property_list_add_int(scale_prop, "25%", 25);
+    
+    obs_property_t* filter_prop = obs_properties_add_list(props, PROP_UPSCALE_FILTER, TEXT_UPSCALE_FILTER, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_set_long_description(filter_prop, TEXT_UPSCALE_FILTER_TOOLTIP);
+    obs_property_list_add_int(filter_prop, TEXT_UPSCALE_FILTER_BILINEAR, UPSCALE_FILTER_BILINEAR);
+    obs_property_list_add_int(filter_prop, TEXT_UPSCALE_FILTER_BICUBIC, UPSCALE_FILTER_BICUBIC);
+    
+    // Built-in effects, drawn in the source's own pass
+    obs_properties_t* effects_props = obs_properties_create();
+    
+    obs_property_t* key_prop = obs_properties_add_list(effects_props, PROP_KEY_MODE, TEXT_KEY_MODE, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_set_long_description(key_prop, TEXT_KEY_MODE_TOOLTIP);
+    obs_property_list_add_int(key_prop, TEXT_KEY_MODE_NONE, FUSED_KEY_NONE);
+    obs_property_list_add_int(key_prop, TEXT_KEY_MODE_CHROMA, FUSED_KEY_CHROMA);
+    obs_property_list_add_int(key_prop, TEXT_KEY_MODE_COLOR, FUSED_KEY_COLOR);
+    
+    obs_properties_add_color(effects_props, PROP_KEY_COLOR, TEXT_KEY_COLOR);
+    obs_properties_add_int_slider(effects_props, PROP_KEY_SIMILARITY, TEXT_KEY_SIMILARITY, 1, 1000, 1);
+    obs_properties_add_int_slider(effects_props, PROP_KEY_SMOOTHNESS, TEXT_KEY_SMOOTHNESS, 1, 1000, 1);
+    
+    obs_property_t* opacity_prop = obs_properties_add_int_slider(effects_props, PROP_OPACITY, TEXT_OPACITY, 0, 100, 1);
+    obs_property_int_set_suffix(opacity_prop, "%");
+    
+    obs_properties_add_int(effects_props, PROP_CROP_LEFT, TEXT_CROP_LEFT, 0, MAX_WIDTH, 1);
+    obs_properties_add_int(effects_props, PROP_CROP_TOP, TEXT_CROP_TOP, 0, MAX_HEIGHT, 1);
+    obs_properties_add_int(effects_props, PROP_CROP_RIGHT, TEXT_CROP_RIGHT, 0, MAX_WIDTH, 1);
+    obs_properties_add_int(effects_props, PROP_CROP_BOTTOM, TEXT_CROP_BOTTOM, 0, MAX_HEIGHT, 1);
+    
+    obs_properties_add_group(props, PROP_EFFECTS_GROUP, TEXT_EFFECTS_GROUP, OBS_GROUP_NORMAL, effects_props);
+    
     // Volume slider
     obs_property_t* volume_prop = obs_properties_add_float_slider(props, PROP_VOLUME, TEXT_VOLUME, 0.0, 1.0, 0.01);
     obs_property_set_long_description(volume_prop, TEXT_VOLUME_TOOLTIP);
@@ -118,10 +204,98 @@ obs_properties_t* chromium_source_get_properties(void* data) {
     obs_property_set_long_description(auto_reload_prop, TEXT_AUTO_RELOAD_TOOLTIP);
     obs_property_set_modified_callback(auto_reload_prop, ChromiumSourceProperties::auto_reload_modified);
     
+    // Reload policy
+    obs_property_t* policy_prop = obs_properties_add_list(advanced_group, PROP_RELOAD_POLICY, TEXT_RELOAD_POLICY, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_set_long_description(policy_prop, TEXT_RELOAD_POLICY_TOOLTIP);
+    obs_property_list_add_int(policy_prop, TEXT_RELOAD_POLICY_HEALTH, RELOAD_POLICY_HEALTH);
+    obs_property_list_add_int(policy_prop, TEXT_RELOAD_POLICY_INTERVAL, RELOAD_POLICY_INTERVAL);
+    obs_property_set_modified_callback(policy_prop, ChromiumSourceProperties::reload_policy_modified);
+    
     // Reload interval
     obs_property_t* interval_prop = obs_properties_add_int_slider(advanced_group, PROP_RELOAD_INTERVAL, TEXT_RELOAD_INTERVAL, MIN_RELOAD_INTERVAL, MAX_RELOAD_INTERVAL, 1);
     obs_property_set_long_description(interval_prop, TEXT_RELOAD_INTERVAL_TOOLTIP);
     
+    // Renderer memory limit
+    obs_property_t* memory_prop = obs_properties_add_int(advanced_group, PROP_MEMORY_LIMIT, TEXT_MEMORY_LIMIT, 0, MAX_MEMORY_LIMIT, 64);
+    obs_property_set_long_description(memory_prop, TEXT_MEMORY_LIMIT_TOOLTIP);
+    
+    // Alert media prefetch into the asset cache
+    obs_property_t* prefetch_prop = obs_properties_add_list(advanced_group, PROP_PREFETCH_MODE, TEXT_PREFETCH_MODE, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_set_long_description(prefetch_prop, TEXT_PREFETCH_MODE_TOOLTIP);
+    obs_property_list_add_int(prefetch_prop, TEXT_PREFETCH_MODE_OFF, PREFETCH_MODE_OFF);
+    obs_property_list_add_int(prefetch_prop, TEXT_PREFETCH_MODE_LEARNED, PREFETCH_MODE_LEARNED);
+    obs_property_list_add_int(prefetch_prop, TEXT_PREFETCH_MODE_MANIFEST, PREFETCH_MODE_MANIFEST);
+    obs_property_set_modified_callback(prefetch_prop, ChromiumSourceProperties::prefetch_mode_modified);
+    
+    obs_property_t* manifest_prop = obs_properties_add_text(advanced_group, PROP_PREFETCH_MANIFEST, TEXT_PREFETCH_MANIFEST, OBS_TEXT_MULTILINE);
+    obs_property_set_long_description(manifest_prop, TEXT_PREFETCH_MANIFEST_TOOLTIP);
+    
+    // Crash recovery test
+    obs_property_t* crash_prop = obs_properties_add_button(advanced_group, PROP_CRASH_TEST_BUTTON, TEXT_CRASH_TEST_BUTTON, ChromiumSourceProperties::crash_test_button_clicked);
+    obs_property_set_long_description(crash_prop, TEXT_CRASH_TEST_BUTTON_TOOLTIP);
+    
+    // Health status of the running browser
+    if (data) {
+        ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(data);
+        std::string health = std::string(TEXT_HEALTH_INFO) + ": " + impl->GetHealthSummary();
+        obs_properties_add_text(advanced_group, PROP_HEALTH_INFO, health.c_str(), OBS_TEXT_INFO);
+        
+        std::string memory = std::string(TEXT_MEMORY_INFO) + ": " + impl->GetMemorySummary();
+        obs_properties_add_text(advanced_group, PROP_MEMORY_INFO, memory.c_str(), OBS_TEXT_INFO);
+        
+        std::string blocked = std::string(TEXT_BLOCKED_INFO) + ": " + impl->GetBlockedSummary();
+        obs_properties_add_text(advanced_group, PROP_BLOCKED_INFO, blocked.c_str(), OBS_TEXT_INFO);
+        
+        std::string resident = std::string(TEXT_RESIDENT_INFO) + ": " + impl->GetResidentSummary();
+        obs_properties_add_text(advanced_group, PROP_RESIDENT_INFO, resident.c_str(), OBS_TEXT_INFO);
+        
+        // Plugin-wide, shared by all sources
+        UploadStats stats = UploadScheduler::GetInstance()->GetStats();
+        char upload[192];
+        snprintf(upload, sizeof(upload), "%s: %llu uploads | %llu deferred | %llu coalesced | over budget in %llu of %llu frames",
+                 TEXT_UPLOAD_INFO, (unsigned long long)stats.uploads, (unsigned long long)stats.deferred,
+                 (unsigned long long)stats.coalesced, (unsigned long long)stats.over_budget,
+                 (unsigned long long)stats.frames);
+        obs_properties_add_text(advanced_group, PROP_UPLOAD_INFO, upload, OBS_TEXT_INFO);
+        
+        TexturePoolStats textures = TexturePool::GetInstance()->GetStats();
+        char pool[192];
+        snprintf(pool, sizeof(pool), "%s: %.1f MB held (%.1f MB idle) | %llu reused | %llu created",
+                 TEXT_TEXTURE_POOL_INFO, (textures.live_bytes + textures.idle_bytes) / (1024.0 * 1024.0),
+                 textures.idle_bytes / (1024.0 * 1024.0), (unsigned long long)textures.reused,
+                 (unsigned long long)textures.created);
+        obs_properties_add_text(advanced_group, PROP_TEXTURE_POOL_INFO, pool, OBS_TEXT_INFO);
+        
+        char cache[128];
+        snprintf(cache, sizeof(cache), "%s: %llu redundant draws avoided", TEXT_RENDER_CACHE_INFO,
+                 (unsigned long long)impl->GetRedundantDrawsAvoided());
+        obs_properties_add_text(advanced_group, PROP_RENDER_CACHE_INFO, cache, OBS_TEXT_INFO);
+        
+        AssetCacheStats assets = AssetCache::GetInstance()->GetStats();
+        uint64_t lookups = assets.hits + assets.misses;
+        char asset_cache[192];
+        snprintf(asset_cache, sizeof(asset_cache), "%s: %.0f%% hit rate (%llu of %llu) | %.1f MB saved | %zu assets, %.1f MB stored",
+                 TEXT_ASSET_CACHE_INFO, lookups ? assets.hits * 100.0 / lookups : 0.0,
+                 (unsigned long long)assets.hits, (unsigned long long)lookups,
+                 assets.bytes_saved / (1024.0 * 1024.0), assets.entries,
+                 assets.stored_bytes / (1024.0 * 1024.0));
+        obs_properties_add_text(advanced_group, PROP_ASSET_CACHE_INFO, asset_cache, OBS_TEXT_INFO);
+    }
+    
+    return props;
+}
+
+obs_properties_t* chromium_async_source_get_properties(void* data) {
+    obs_properties_t* props = chromium_source_get_properties(data);
+    
+    // OBS draws async frames itself, so nothing of the source's own pass
+    // applies; frames are always painted at full size
+    obs_properties_remove_by_name(props, PROP_AUTO_RESOLUTION);
+    obs_properties_remove_by_name(props, PROP_RENDER_SCALE);
+    obs_properties_remove_by_name(props, PROP_UPSCALE_FILTER);
+    obs_properties_remove_by_name(props, PROP_EFFECTS_GROUP);
+    obs_properties_remove_by_name(props, PROP_RENDER_CACHE_INFO);
+    
     return props;
 }
 
@@ -132,10 +306,22 @@ void chromium_source_get_defaults(obs_data_t* settings) {
     obs_data_set_default_int(settings, PROP_SIZE_PRESET, DEFAULT_SIZE_PRESET);
     obs_data_set_default_bool(settings, PROP_CUSTOM_SIZE, DEFAULT_CUSTOM_SIZE);
     obs_data_set_default_bool(settings, PROP_FORCE_CONTINUOUS, DEFAULT_FORCE_CONTINUOUS);
+    obs_data_set_default_bool(settings, PROP_IDLE_ON_PROGRAM, DEFAULT_IDLE_ON_PROGRAM);
+    obs_data_set_default_bool(settings, PROP_AUTO_RESOLUTION, DEFAULT_AUTO_RESOLUTION);
+    obs_data_set_default_int(settings, PROP_RENDER_SCALE, DEFAULT_RENDER_SCALE);
+    obs_data_set_default_int(settings, PROP_UPSCALE_FILTER, DEFAULT_UPSCALE_FILTER);
+    obs_data_set_default_int(settings, PROP_KEY_MODE, FUSED_KEY_NONE);
+    obs_data_set_default_int(settings, PROP_KEY_COLOR, DEFAULT_KEY_COLOR);
+    obs_data_set_default_int(settings, PROP_KEY_SIMILARITY, DEFAULT_KEY_SIMILARITY);
+    obs_data_set_default_int(settings, PROP_KEY_SMOOTHNESS, DEFAULT_KEY_SMOOTHNESS);
+    obs_data_set_default_int(settings, PROP_OPACITY, 100);
     obs_data_set_default_double(settings, PROP_VOLUME, DEFAULT_VOLUME);
     obs_data_set_default_bool(settings, PROP_MUTED, false);
     obs_data_set_default_bool(settings, PROP_AUTO_RELOAD, DEFAULT_AUTO_RELOAD);
+    obs_data_set_default_int(settings, PROP_RELOAD_POLICY, DEFAULT_RELOAD_POLICY);
+    obs_data_set_default_int(settings, PROP_MEMORY_LIMIT, DEFAULT_MEMORY_LIMIT);
     obs_data_set_default_int(settings, PROP_RELOAD_INTERVAL, DEFAULT_RELOAD_INTERVAL);
+    obs_data_set_default_int(settings, PROP_PREFETCH_MODE, DEFAULT_PREFETCH_MODE);
 }
 
 void chromium_source_enum_active_sources(void* data, obs_source_enum_proc_t enum_callback, void* param) {
@@ -148,67 +334,201 @@ void chromium_source_enum_active_sources(void* data, obs_source_enum_proc_t enum
 // ChromiumSourceImpl implementation
 ChromiumSourceImpl::ChromiumSourceImpl(obs_source_t* source)
     : obs_source_(source)
+    , async_(strcmp(obs_source_get_id(source), CHROMIUM_ASYNC_SOURCE_ID) == 0)
     , width_(DEFAULT_WIDTH)
     , height_(DEFAULT_HEIGHT)
     , force_continuous_playback_(DEFAULT_FORCE_CONTINUOUS)
+    , idle_on_program_(DEFAULT_IDLE_ON_PROGRAM)
+    , auto_resolution_(DEFAULT_AUTO_RESOLUTION)
+    , render_scale_percent_(DEFAULT_RENDER_SCALE)
+    , upscale_filter_(DEFAULT_UPSCALE_FILTER)
+    , crop_left_(0)
+    , crop_top_(0)
+    , crop_right_(0)
+    , crop_bottom_(0)
     , volume_(DEFAULT_VOLUME)
     , muted_(false)
     , auto_reload_(DEFAULT_AUTO_RELOAD)
+    , memory_limit_mb_(DEFAULT_MEMORY_LIMIT)
+    , reload_policy_(DEFAULT_RELOAD_POLICY)
     , reload_interval_(DEFAULT_RELOAD_INTERVAL)
-    , texture_(nullptr)
-    , last_reload_time_(0.0f) {
+    , prefetch_mode_(DEFAULT_PREFETCH_MODE)
+    , shadow_started_ns_(0)
+    , last_reload_time_(0.0f)
+    , browser_pending_(false)
+    , health_state_(HealthState::Starting)
+    , crash_cooldown_until_ns_(0)
+    , recovering_since_ns_(0)
+    , respawn_pending_(false)
+    , memory_checked_ns_(0)
+    , memory_recycled_ns_(0)
+    , memory_shared_warned_(false)
+    , render_scale_(1.0f)
+    , auto_res_checked_ns_(0)
+    , auto_res_shrink_since_ns_(0)
+    , owns_browser_(false)
+    , active_(false)
+    , showing_(false)
+    , counted_active_(false)
+    , counted_showing_(false)
+    , tier_(RenderTier::Hidden)
+    , adopt_pending_(false)
+    , render_cache_(nullptr)
+    , render_cache_valid_(false)
+    , use_render_cache_(false)
+    , render_frame_time_(0)
+    , render_frame_draws_(0)
+    , redundant_draws_avoided_(0)
+    , pending_settings_(nullptr)
+    , pending_since_ns_(0)
+    , pending_updates_(0)
+    , removed_(false)
+    , requests_(0)
+    , hidden_since_ns_(0)
+    , frame_released_(false)
+    , released_bytes_(0)
+    , thumbnail_bytes_(0) {
     
     url_ = DEFAULT_URL;
     
-    // Initialize texture mutex
-    if (pthread_mutex_init(&texture_mutex_, nullptr) != 0) {
-        blog(LOG_ERROR, "[Chromium Source] Failed to initialize texture mutex");
-    }
+    signal_handler_connect(obs_source_get_signal_handler(source), "remove", OnSourceRemoved, this);
 }
 
 ChromiumSourceImpl::~ChromiumSourceImpl() {
-    DestroyBrowser();
+    signal_handler_disconnect(obs_source_get_signal_handler(obs_source_), "remove", OnSourceRemoved, this);
+    
+    // Keep the last frame for the next start
+    if (frame_ && !async_ && !removed_) {
+        RestoreReleasedFrame();
+        FrameSnapshotStore::GetInstance()->Save(obs_source_get_uuid(obs_source_), url_, frame_.get());
+    }
+    
+    // Texture and mutex are released with the last source sharing the frame
+    LeaveRegistry();
+    
+    obs_data_release(pending_settings_);
+    
+    if (audio_) {
+        audio_->Shutdown();
+        audio_.reset();
+    }
     
-    // Cleanup texture
-    if (texture_) {
+    if (render_cache_) {
         obs_enter_graphics();
-        gs_texture_destroy(texture_);
+        gs_texrender_destroy(render_cache_);
         obs_leave_graphics();
-        texture_ = nullptr;
     }
-    
-    // Cleanup mutex
-    pthread_mutex_destroy(&texture_mutex_);
 }
 
 bool ChromiumSourceImpl::Initialize(obs_data_t* settings) {
-    if (!CEFManager::IsInitialized()) {
-        blog(LOG_ERROR, "[Chromium Source] Cannot initialize: CEF not ready");
+    if (!ChromiumPlugin::GetInstance()->EnsureCEFStarted()) {
+        blog(LOG_ERROR, "[Chromium Source] Cannot initialize: CEF failed to start");
         return false;
     }
     
+    MigrateSettings(settings);
     LoadSettings(settings);
-    CreateBrowser();
+    
+    // Audio stays per source, even when the browser is shared
+    audio_ = std::make_unique<CEFAudio>(nullptr); // Pass nullptr since we're managing it here
+    if (audio_->Initialize()) {
+        audio_->SetVolume(volume_);
+        audio_->SetMuted(muted_);
+    } else {
+        blog(LOG_ERROR, "[Chromium Source] Failed to initialize audio system");
+        audio_.reset();
+    }
+    
+    // The browser is created as soon as CEF is ready; until then VideoTick polls
+    if (!CEFManager::IsInitialized()) {
+        blog(LOG_INFO, "[Chromium Source] Waiting for CEF before creating browser");
+    }
+    JoinRegistry();
+    
+    // Show the page as it last looked until the browser paints; async
+    // sources have no staging buffer to put it in
+    if (owns_browser_ && !async_) {
+        FrameSnapshotStore::GetInstance()->Restore(obs_source_get_uuid(obs_source_), url_, frame_.get());
+    }
     
     blog(LOG_INFO, "[Chromium Source] Source initialized successfully");
     return true;
 }
 
+void ChromiumSourceImpl::OnSourceRemoved(void* data, calldata_t* calldata) {
+    UNUSED_PARAMETER(calldata);
+    ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(data);
+    impl->removed_ = FrameSnapshotStore::GetInstance()->Remove(obs_source_get_uuid(impl->obs_source_));
+}
+
 void ChromiumSourceImpl::Update(obs_data_t* settings) {
+    // Audio is cheap to change and expected to follow the slider
+    volume_ = std::clamp((float)obs_data_get_double(settings, PROP_VOLUME), 0.0f, 1.0f);
+    muted_ = obs_data_get_bool(settings, PROP_MUTED);
+    if (audio_) {
+        audio_->SetVolume(volume_);
+        audio_->SetMuted(muted_);
+    }
+    
+    // Only the newest settings matter; earlier ones are dropped unapplied
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    if (pending_settings_ != settings) {
+        obs_data_addref(settings);
+        obs_data_release(pending_settings_);
+        pending_settings_ = settings;
+    }
+    pending_since_ns_ = os_gettime_ns();
+    pending_updates_++;
+}
+
+void ChromiumSourceImpl::ApplyPendingSettings(uint64_t now_ns) {
+    obs_data_t* settings;
+    uint32_t updates;
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex_);
+        if (!pending_settings_ || now_ns - pending_since_ns_ < SETTINGS_QUIET_NS) {
+            return;
+        }
+        settings = pending_settings_;
+        updates = pending_updates_;
+        pending_settings_ = nullptr;
+        pending_updates_ = 0;
+    }
+    
+    if (updates > 1) {
+        blog(LOG_DEBUG, "[Chromium Source] Applying settings once for %u updates", updates);
+    }
+    ApplySettings(settings);
+    obs_data_release(settings);
+}
+
+void ChromiumSourceImpl::ApplySettings(obs_data_t* settings) {
     std::string old_url = url_;
     int old_width = width_;
     int old_height = height_;
     
     LoadSettings(settings);
+    SharePrefetch();
     
-    // Update audio settings
-    if (audio_) {
-        audio_->SetVolume(volume_);
-        audio_->SetMuted(muted_);
+    BrowserKey key = MakeKey();
+    if (key == key_) {
+        return;
     }
     
+    // Identical sources share one browser; only a source alone on its
+    // browser may navigate or resize it in place
+    if (!owns_browser_ || !BrowserRegistry::GetInstance()->Rekey(this, key)) {
+        LeaveRegistry();
+        JoinRegistry();
+        return;
+    }
+    key_ = key;
+    
     // Check if browser needs to be recreated or updated
     if (url_ != old_url) {
+        // A pending reload would bring back the old URL
+        CancelShadowBrowser();
+        
         if (browser_ && browser_->IsValid()) {
             browser_->LoadURL(url_);
         } else {
@@ -223,8 +543,99 @@ void ChromiumSourceImpl::Update(obs_data_t* settings) {
 }
 
 void ChromiumSourceImpl::VideoTick(float seconds) {
-    // Handle auto reload
-    if (auto_reload_ && reload_interval_ > 0) {
+    // Pick up the browser of an identical source that went away
+    {
+        std::lock_guard<std::mutex> lock(adopt_mutex_);
+        if (adopt_pending_) {
+            adopt_pending_ = false;
+            owns_browser_ = true;
+            browser_ = std::move(adopted_browser_);
+            browser_pending_ = !browser_;
+            if (browser_) {
+                browser_->SetDeviceScale(render_scale_);
+            }
+        }
+    }
+    
+    // Settings that have stopped changing, possibly rejoining the registry
+    ApplyPendingSettings(os_gettime_ns());
+    
+    // Scene switches since the last tick. The owner may already have
+    // ticked this frame, so it applies the new counts right away.
+    if (CountVisibility() && !owns_browser_) {
+        BrowserRegistry::GetInstance()->ApplyOwnerRenderTier(this);
+    }
+    
+    // Tell the upload scheduler where this source is being shown
+    int visible = obs_source_active(obs_source_) ? UPLOAD_VISIBLE_PROGRAM :
+                  obs_source_showing(obs_source_) ? UPLOAD_VISIBLE_PREVIEW : 0;
+    if (frame_) {
+        frame_->visibility.fetch_or(visible);
+    }
+    if (shadow_frame_) {
+        shadow_frame_->visibility.fetch_or(visible);
+    }
+    
+    // Requests from the properties reach the browser's owner through the
+    // shared frame
+    int requests = requests_.exchange(0);
+    if (frame_ && requests) {
+        frame_->requests.fetch_or(requests);
+    }
+    
+    // The owning source drives the shared browser
+    if (!owns_browser_) {
+        return;
+    }
+    
+    // Async sources have no render callback to swap in a reload from
+    if (async_ && shadow_browser_) {
+        PromoteShadowBrowser();
+    }
+    
+    // Catches up after browser creation, adoption and settings changes
+    ApplyRenderTier();
+    
+    // A released page shows its thumbnail until it paints again
+    if (tier_ != RenderTier::Hidden) {
+        RestoreReleasedFrame();
+    }
+    
+    // Create the browser once the background CEF startup has finished
+    if (browser_pending_) {
+        if (CEFManager::IsInitialized()) {
+            CreateBrowser();
+        } else if (CEFManager::HasFailed()) {
+            blog(LOG_ERROR, "[Chromium Source] CEF failed to start, browser not created");
+            browser_pending_ = false;
+        }
+    }
+    
+    // Browsers are created on the CEF thread without holding up this one;
+    // one CEF could not create is given up here
+    if (browser_ && browser_->HasCreateFailed()) {
+        blog(LOG_ERROR, "[Chromium Source] Failed to initialize browser");
+        browser_.reset();
+    }
+    if (shadow_browser_ && shadow_browser_->HasCreateFailed()) {
+        blog(LOG_WARNING, "[Chromium Source] Shadow browser failed, reloading in place");
+        CancelShadowBrowser();
+        if (browser_) {
+            browser_->Reload();
+        }
+    }
+    
+    // Buttons pressed on this or any source sharing the browser
+    requests = frame_->requests.exchange(0);
+    if (requests & SOURCE_REQUEST_RELOAD) {
+        ReloadBrowser();
+    }
+    if (requests & SOURCE_REQUEST_CRASH_TEST) {
+        SimulateRendererCrash();
+    }
+    
+    // Handle fixed-interval auto reload
+    if (auto_reload_ && reload_policy_ == RELOAD_POLICY_INTERVAL && reload_interval_ > 0) {
         last_reload_time_ += seconds;
         if (last_reload_time_ >= reload_interval_) {
             ReloadBrowser();
@@ -232,6 +643,23 @@ void ChromiumSourceImpl::VideoTick(float seconds) {
         }
     }
     
+    uint64_t now_ns = os_gettime_ns();
+    
+    // Crashed renderers are replaced right away, independent of auto reload
+    HandleRendererCrash(now_ns);
+    
+    // Health checks run regardless so the state can be shown in properties
+    CheckHealth(now_ns);
+    
+    // Recycle leaking pages before they take the machine down
+    CheckMemory(now_ns);
+    
+    // Paint at the configured scale, and no larger than the page is shown
+    CheckRenderScale(now_ns);
+    
+    // Give back frame memory of a page nobody has looked at for a while
+    CheckIdleRelease(now_ns);
+    
     // Force browser invalidation for continuous playback
     if (force_continuous_playback_ && browser_) {
         browser_->Invalidate();
@@ -239,22 +667,209 @@ void ChromiumSourceImpl::VideoTick(float seconds) {
 }
 
 void ChromiumSourceImpl::VideoRender(gs_effect_t* effect) {
-    pthread_mutex_lock(&texture_mutex_);
+    if (!frame_) {
+        return;
+    }
+    
+    // Swap in a reloaded page only once it has something to show
+    if (shadow_browser_) {
+        PromoteShadowBrowser();
+    }
+    
+    // Custom draw: OBS passes no effect, the source picks its own
+    UNUSED_PARAMETER(effect);
+    
+    profile_start(video_render_name);
+    
+    // Multiview, projectors and nested scenes draw a source several times
+    // per frame. Once that is seen and the draw itself is costly, the
+    // first draw of a frame renders into a cache and the others only copy
+    // it; a plain draw is cheaper than the extra pass.
+    uint64_t frame_time = obs_get_video_frame_time();
+    if (frame_time != render_frame_time_) {
+        use_render_cache_ = render_frame_draws_ > 1 && IsDrawExpensive();
+        render_frame_time_ = frame_time;
+        render_frame_draws_ = 0;
+        render_cache_valid_ = false;
+    }
+    render_frame_draws_++;
+    
+    if (use_render_cache_) {
+        if (render_cache_valid_) {
+            redundant_draws_avoided_++;
+        } else {
+            render_cache_valid_ = RenderToCache();
+        }
+    }
+    
+    // CEF paints premultiplied BGRA; blending it as straight alpha would
+    // darken antialiased edges
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    
+    if (render_cache_valid_) {
+        gs_effect_t* draw_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+        gs_texture_t* cached = gs_texrender_get_texture(render_cache_);
+        gs_effect_set_texture(gs_effect_get_param_by_name(draw_effect, "image"), cached);
+        while (gs_effect_loop(draw_effect, "Draw")) {
+            gs_draw_sprite(cached, 0, GetWidth(), GetHeight());
+        }
+    } else {
+        DrawFrame();
+    }
+    
+    gs_blend_state_pop();
+    profile_end(video_render_name);
+}
+
+bool ChromiumSourceImpl::IsDrawExpensive() const {
+    // Key or opacity permutation, see DrawFrame
+    if (fused_effect_.IsActive(effect_settings_)) {
+        return true;
+    }
+    if (upscale_filter_ != UPSCALE_FILTER_BICUBIC) {
+        return false;
+    }
+    
+    // Bicubic only runs on a texture painted below the logical size
+    pthread_mutex_lock(&frame_->texture_mutex);
+    bool upscaled = frame_->texture && (frame_->upload_width < width_ || frame_->upload_height < height_);
+    pthread_mutex_unlock(&frame_->texture_mutex);
+    return upscaled;
+}
+
+bool ChromiumSourceImpl::RenderToCache() {
+    if (!render_cache_) {
+        render_cache_ = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+    }
+    
+    uint32_t width = GetWidth();
+    uint32_t height = GetHeight();
+    
+    gs_texrender_reset(render_cache_);
+    if (!gs_texrender_begin(render_cache_, width, height)) {
+        return false;
+    }
+    
+    struct vec4 clear_color;
+    vec4_zero(&clear_color);
+    gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+    gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+    
+    // Copy the premultiplied pixels as is; they are blended once the
+    // cache is drawn
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+    DrawFrame();
+    gs_blend_state_pop();
+    
+    gs_texrender_end(render_cache_);
+    return true;
+}
+
+void ChromiumSourceImpl::DrawFrame() {
+    pthread_mutex_lock(&frame_->texture_mutex);
+    
+    if (frame_->texture) {
+        gs_texture_t* texture = frame_->texture;
+        
+        // The paint may fill only the top-left corner of a pooled texture
+        uint32_t tex_width = (uint32_t)frame_->upload_width;
+        uint32_t tex_height = (uint32_t)frame_->upload_height;
+        bool partial = tex_width != gs_texture_get_width(texture) || tex_height != gs_texture_get_height(texture);
+        
+        // Key and opacity are applied in this same draw when enabled
+        gs_effect_t* fused = fused_effect_.Prepare(effect_settings_);
+        
+        // A texture painted below the logical size is stretched back up
+        // here; the default and fused effects sample bilinearly
+        bool bicubic = !fused && upscale_filter_ == UPSCALE_FILTER_BICUBIC &&
+                       (tex_width < (uint32_t)width_ || tex_height < (uint32_t)height_);
+        gs_effect_t* draw_effect = fused ? fused : obs_get_base_effect(bicubic ? OBS_EFFECT_BICUBIC : OBS_EFFECT_DEFAULT);
+        
+        gs_effect_set_texture(gs_effect_get_param_by_name(draw_effect, "image"), texture);
+        if (bicubic) {
+            struct vec2 base;
+            struct vec2 base_i;
+            vec2_set(&base, (float)gs_texture_get_width(texture), (float)gs_texture_get_height(texture));
+            vec2_set(&base_i, 1.0f / base.x, 1.0f / base.y);
+            gs_effect_set_vec2(gs_effect_get_param_by_name(draw_effect, "base_dimension"), &base);
+            gs_effect_set_vec2(gs_effect_get_param_by_name(draw_effect, "base_dimension_i"), &base_i);
+            
+            // Only present in newer OBS versions
+            gs_eparam_t* undistort = gs_effect_get_param_by_name(draw_effect, "undistort_factor");
+            if (undistort) {
+                gs_effect_set_float(undistort, 1.0f);
+            }
+        }
+        
+        uint32_t out_width = GetWidth();
+        uint32_t out_height = GetHeight();
+        bool cropped = out_width != (uint32_t)width_ || out_height != (uint32_t)height_;
+        
+        while (gs_effect_loop(draw_effect, "Draw")) {
+            if (!cropped && !partial) {
+                gs_draw_sprite(texture, 0, width_, height_);
+                continue;
+            }
+            
+            // Crop and a partly filled texture are only a smaller source
+            // rectangle, no extra pass
+            float scale_x = (float)tex_width / (float)width_;
+            float scale_y = (float)tex_height / (float)height_;
+            gs_matrix_push();
+            gs_matrix_scale3f(1.0f / scale_x, 1.0f / scale_y, 1.0f);
+            gs_draw_sprite_subregion(texture, 0,
+                                     (uint32_t)std::lround(crop_left_ * scale_x), (uint32_t)std::lround(crop_top_ * scale_y),
+                                     (uint32_t)std::lround(out_width * scale_x), (uint32_t)std::lround(out_height * scale_y));
+            gs_matrix_pop();
+        }
+    }
+    
+    pthread_mutex_unlock(&frame_->texture_mutex);
+}
+
+void ChromiumSourceImpl::RenderRegion(gs_effect_t* effect, int x, int y, int width, int height) {
+    if (!frame_) {
+        return;
+    }
     
-    if (texture_) {
-        gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture_);
-        gs_draw_sprite(texture_, 0, width_, height_);
+    pthread_mutex_lock(&frame_->texture_mutex);
+    
+    if (frame_->texture) {
+        width = std::min(width, width_ - x);
+        height = std::min(height, height_ - y);
+        
+        if (width > 0 && height > 0) {
+            // The region is in page pixels; the texture may be painted
+            // below the page's logical size
+            float scale_x = (float)frame_->upload_width / (float)width_;
+            float scale_y = (float)frame_->upload_height / (float)height_;
+            
+            // Premultiplied, like in VideoRender
+            gs_blend_state_push();
+            gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+            
+            gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), frame_->texture);
+            gs_matrix_push();
+            gs_matrix_scale3f(1.0f / scale_x, 1.0f / scale_y, 1.0f);
+            gs_draw_sprite_subregion(frame_->texture, 0,
+                                     (uint32_t)std::lround(x * scale_x), (uint32_t)std::lround(y * scale_y),
+                                     (uint32_t)std::lround(width * scale_x), (uint32_t)std::lround(height * scale_y));
+            gs_matrix_pop();
+            gs_blend_state_pop();
+        }
     }
     
-    pthread_mutex_unlock(&texture_mutex_);
+    pthread_mutex_unlock(&frame_->texture_mutex);
 }
 
 uint32_t ChromiumSourceImpl::GetWidth() const {
-    return width_;
+    return (uint32_t)std::max(width_ - crop_left_ - crop_right_, 1);
 }
 
 uint32_t ChromiumSourceImpl::GetHeight() const {
-    return height_;
+    return (uint32_t)std::max(height_ - crop_top_ - crop_bottom_, 1);
 }
 
 void ChromiumSourceImpl::EnumActiveSources(obs_source_enum_proc_t enum_callback, void* param) {
@@ -267,6 +882,19 @@ obs_source_t* ChromiumSourceImpl::GetSource() const {
     return obs_source_;
 }
 
+void ChromiumSourceImpl::MigrateSettings(obs_data_t* settings) {
+    // Sources saved before the reload policy existed reloaded on their
+    // interval; keep them doing so rather than switching them to health
+    // checks. Only saved settings get here without a policy, so a new
+    // source turning auto reload on later keeps the default.
+    if (!obs_data_has_user_value(settings, PROP_RELOAD_POLICY) &&
+        obs_data_get_bool(settings, PROP_AUTO_RELOAD)) {
+        obs_data_set_int(settings, PROP_RELOAD_POLICY, RELOAD_POLICY_INTERVAL);
+        blog(LOG_INFO, "[Chromium Source] '%s' keeps its fixed reload interval",
+             obs_source_get_name(obs_source_));
+    }
+}
+
 void ChromiumSourceImpl::LoadSettings(obs_data_t* settings) {
     // Load URL
     const char* url = obs_data_get_string(settings, PROP_URL);
@@ -294,51 +922,253 @@ void ChromiumSourceImpl::LoadSettings(obs_data_t* settings) {
     
     // Load other settings
     force_continuous_playback_ = obs_data_get_bool(settings, PROP_FORCE_CONTINUOUS);
+    idle_on_program_ = obs_data_get_bool(settings, PROP_IDLE_ON_PROGRAM);
+    auto_resolution_ = obs_data_get_bool(settings, PROP_AUTO_RESOLUTION);
+    render_scale_percent_ = (int)obs_data_get_int(settings, PROP_RENDER_SCALE);
+    upscale_filter_ = (int)obs_data_get_int(settings, PROP_UPSCALE_FILTER);
+    crop_left_ = (int)obs_data_get_int(settings, PROP_CROP_LEFT);
+    crop_top_ = (int)obs_data_get_int(settings, PROP_CROP_TOP);
+    crop_right_ = (int)obs_data_get_int(settings, PROP_CROP_RIGHT);
+    crop_bottom_ = (int)obs_data_get_int(settings, PROP_CROP_BOTTOM);
+    effect_settings_.key_mode = (int)obs_data_get_int(settings, PROP_KEY_MODE);
+    effect_settings_.key_color = (uint32_t)obs_data_get_int(settings, PROP_KEY_COLOR);
+    effect_settings_.similarity = (float)obs_data_get_int(settings, PROP_KEY_SIMILARITY) / 1000.0f;
+    effect_settings_.smoothness = (float)obs_data_get_int(settings, PROP_KEY_SMOOTHNESS) / 1000.0f;
+    effect_settings_.opacity = (float)obs_data_get_int(settings, PROP_OPACITY) / 100.0f;
     volume_ = (float)obs_data_get_double(settings, PROP_VOLUME);
     muted_ = obs_data_get_bool(settings, PROP_MUTED);
     auto_reload_ = obs_data_get_bool(settings, PROP_AUTO_RELOAD);
+    reload_policy_ = (int)obs_data_get_int(settings, PROP_RELOAD_POLICY);
+    memory_limit_mb_ = (int)obs_data_get_int(settings, PROP_MEMORY_LIMIT);
+    memory_limit_mb_ = std::clamp(memory_limit_mb_, 0, MAX_MEMORY_LIMIT);
     reload_interval_ = (int)obs_data_get_int(settings, PROP_RELOAD_INTERVAL);
+    prefetch_mode_ = (int)obs_data_get_int(settings, PROP_PREFETCH_MODE);
+    prefetch_manifest_ = AssetPrefetcher::ParseManifest(obs_data_get_string(settings, PROP_PREFETCH_MANIFEST));
     
     // Clamp values
     volume_ = std::clamp(volume_, 0.0f, 1.0f);
+    render_scale_percent_ = std::clamp(render_scale_percent_, MIN_RENDER_SCALE, 100);
+    crop_left_ = std::clamp(crop_left_, 0, width_ - 1);
+    crop_right_ = std::clamp(crop_right_, 0, width_ - 1 - crop_left_);
+    crop_top_ = std::clamp(crop_top_, 0, height_ - 1);
+    crop_bottom_ = std::clamp(crop_bottom_, 0, height_ - 1 - crop_top_);
+    effect_settings_.opacity = std::clamp(effect_settings_.opacity, 0.0f, 1.0f);
+    
+    // Async frames define the source size, so they are always painted full size
+    if (async_) {
+        render_scale_percent_ = 100;
+        auto_resolution_ = false;
+    }
     reload_interval_ = std::clamp(reload_interval_, MIN_RELOAD_INTERVAL, MAX_RELOAD_INTERVAL);
 }
 
+BrowserKey ChromiumSourceImpl::MakeKey() const {
+    BrowserKey key;
+    key.url = url_;
+    key.width = width_;
+    key.height = height_;
+    key.render_scale = render_scale_percent_;
+    key.async = async_;
+    return key;
+}
+
+void ChromiumSourceImpl::JoinRegistry() {
+    key_ = MakeKey();
+    frame_ = BrowserRegistry::GetInstance()->Join(this, key_, obs_source_, owns_browser_);
+    frame_->async_output = async_;
+    SharePrefetch();
+    
+    // Counted by the next VideoTick, which also updates the owner's tier
+    counted_active_ = false;
+    counted_showing_ = false;
+    
+    if (owns_browser_) {
+        CreateBrowser();
+    } else {
+        browser_pending_ = false;
+    }
+}
+
+void ChromiumSourceImpl::SharePrefetch() {
+    // Like the other page settings, the browser's owner decides
+    if (!frame_ || !owns_browser_) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(frame_->prefetch_mutex);
+    frame_->prefetch_mode = prefetch_mode_;
+    frame_->prefetch_manifest = prefetch_manifest_;
+}
+
+void ChromiumSourceImpl::LeaveRegistry() {
+    if (!frame_) {
+        return;
+    }
+    
+    if (counted_active_) {
+        frame_->program_refs--;
+    }
+    if (counted_showing_) {
+        frame_->showing_refs--;
+    }
+    counted_active_ = false;
+    counted_showing_ = false;
+    
+    // Leave first: until then other members' ticks may apply our tier
+    ChromiumSourceImpl* heir = BrowserRegistry::GetInstance()->Leave(this);
+    
+    // A browser handed over but not picked up yet is still ours to pass on
+    {
+        std::lock_guard<std::mutex> lock(adopt_mutex_);
+        if (adopt_pending_) {
+            adopt_pending_ = false;
+            owns_browser_ = true;
+            browser_ = std::move(adopted_browser_);
+        }
+    }
+    
+    CancelShadowBrowser();
+    
+    if (heir) {
+        // The remaining sources keep showing the page without a reload
+        heir->AdoptBrowser(std::move(browser_));
+    } else {
+        DestroyBrowser();
+    }
+    
+    frame_.reset();
+    owns_browser_ = false;
+    browser_pending_ = false;
+    hidden_since_ns_ = 0;
+    thumbnail_ = FrameThumbnail();
+    frame_released_ = false;
+}
+
+void ChromiumSourceImpl::AdoptBrowser(std::unique_ptr<CEFBrowser> browser) {
+    std::lock_guard<std::mutex> lock(adopt_mutex_);
+    adopted_browser_ = std::move(browser);
+    adopt_pending_ = true;
+}
+
 void ChromiumSourceImpl::CreateBrowser() {
     DestroyBrowser();
     
+    // New browsers paint at full size until CheckRenderScale looks again
+    render_scale_ = 1.0f;
+    auto_res_checked_ns_ = 0;
+    
     if (!CEFManager::IsInitialized()) {
-        blog(LOG_ERROR, "[Chromium Source] Cannot create browser: CEF not initialized");
+        // Picked up again by VideoTick once CEF is ready
+        browser_pending_ = true;
         return;
     }
+    browser_pending_ = false;
     
-    // Create audio system
-    audio_ = std::make_unique<CEFAudio>(nullptr); // Pass nullptr since we're managing it here
-    if (!audio_->Initialize()) {
-        blog(LOG_ERROR, "[Chromium Source] Failed to initialize audio system");
-        audio_.reset();
+    // Prefer a pre-spawned browser from the pool
+    browser_ = BrowserPool::GetInstance()->Checkout(frame_, url_, width_, height_);
+    if (browser_) {
+        blog(LOG_INFO, "[Chromium Source] Browser checked out from pool for URL: %s", url_.c_str());
+        ApplyRenderTier();
+        return;
     }
     
     // Create browser
-    browser_ = std::make_unique<CEFBrowser>(nullptr); // Pass nullptr since we're managing it here
+    browser_ = std::make_unique<CEFBrowser>(frame_);
     if (!browser_->Initialize(url_, width_, height_)) {
         blog(LOG_ERROR, "[Chromium Source] Failed to initialize browser");
         browser_.reset();
         return;
     }
     
-    blog(LOG_INFO, "[Chromium Source] Browser created successfully for URL: %s", url_.c_str());
+    blog(LOG_INFO, "[Chromium Source] Browser creation started for URL: %s", url_.c_str());
+    ApplyRenderTier();
 }
 
-void ChromiumSourceImpl::DestroyBrowser() {
+void ChromiumSourceImpl::Activate() {
+    active_ = true;
+}
+
+void ChromiumSourceImpl::Deactivate() {
+    active_ = false;
+}
+
+void ChromiumSourceImpl::Show() {
+    showing_ = true;
+}
+
+void ChromiumSourceImpl::Hide() {
+    showing_ = false;
+}
+
+bool ChromiumSourceImpl::CountVisibility() {
+    if (!frame_) {
+        return false;
+    }
+    
+    bool changed = false;
+    
+    bool active = active_;
+    if (active != counted_active_) {
+        frame_->program_refs += active ? 1 : -1;
+        counted_active_ = active;
+        changed = true;
+    }
+    
+    bool showing = showing_;
+    if (showing != counted_showing_) {
+        frame_->showing_refs += showing ? 1 : -1;
+        counted_showing_ = showing;
+        changed = true;
+    }
+    
+    return changed;
+}
+
+void ChromiumSourceImpl::ApplyRenderTier() {
+    if (!frame_) {
+        return;
+    }
+    
+    RenderTier tier = frame_->program_refs > 0 ? RenderTier::Program :
+                      frame_->showing_refs > 0 ? RenderTier::Preview : RenderTier::Hidden;
+    
+    // Force continuous keeps hidden pages painting, at the preview rate
+    if (tier == RenderTier::Hidden && force_continuous_playback_) {
+        tier = RenderTier::Preview;
+    }
+    
+    // Pages on the alert bridge only need full rate while an alert plays.
+    // On Program they keep it between alerts unless the user opted in.
+    if (tier != RenderTier::Hidden) {
+        if (frame_->alerts.IsActive(os_gettime_ns())) {
+            tier = RenderTier::Program;
+        } else if (frame_->alerts.IsDeclared() && (tier != RenderTier::Program || idle_on_program_)) {
+            tier = RenderTier::Idle;
+        }
+    }
+    
+    if (tier != tier_) {
+        blog(LOG_DEBUG, "[Chromium Source] '%s' render tier %d -> %d",
+             obs_source_get_name(obs_source_), (int)tier_, (int)tier);
+        tier_ = tier;
+    }
+    
     if (browser_) {
-        browser_->Close();
-        browser_.reset();
+        browser_->SetRenderTier(tier);
     }
     
-    if (audio_) {
-        audio_->Shutdown();
-        audio_.reset();
+    // A reload has to paint before it can be swapped in
+    if (shadow_browser_) {
+        shadow_browser_->SetRenderTier(tier == RenderTier::Hidden ? RenderTier::Preview : tier);
+    }
+}
+
+void ChromiumSourceImpl::DestroyBrowser() {
+    CancelShadowBrowser();
+    
+    if (browser_) {
+        // Hand the browser back so the next source can reuse its renderer
+        BrowserPool::GetInstance()->Return(std::move(browser_));
     }
 }
 
@@ -347,15 +1177,524 @@ void ChromiumSourceImpl::UpdateBrowserSize() {
         browser_->Resize(width_, height_);
         blog(LOG_INFO, "[Chromium Source] Browser resized to %dx%d", width_, height_);
     }
+    
+    if (shadow_browser_ && shadow_browser_->IsValid()) {
+        shadow_browser_->Resize(width_, height_);
+    }
+}
+
+void ChromiumSourceImpl::RequestReload() {
+    requests_.fetch_or(SOURCE_REQUEST_RELOAD);
+}
+
+void ChromiumSourceImpl::RequestCrashTest() {
+    requests_.fetch_or(SOURCE_REQUEST_CRASH_TEST);
 }
 
 void ChromiumSourceImpl::ReloadBrowser() {
-    if (browser_ && browser_->IsValid()) {
+    if (!browser_ || !browser_->IsValid()) {
+        return;
+    }
+    
+    if (shadow_browser_) {
+        blog(LOG_INFO, "[Chromium Source] Reload already in progress");
+        return;
+    }
+    
+    if (StartShadowBrowser()) {
+        blog(LOG_INFO, "[Chromium Source] Reloading in shadow browser");
+    } else {
+        blog(LOG_WARNING, "[Chromium Source] Shadow browser failed, reloading in place");
         browser_->Reload();
-        blog(LOG_INFO, "[Chromium Source] Browser reloaded");
     }
 }
 
+bool ChromiumSourceImpl::StartShadowBrowser() {
+    // Load the page again next to the live one; the old texture stays on screen
+    shadow_frame_ = std::make_shared<ChromiumSource>();
+    shadow_frame_->source = obs_source_;
+    
+    // An async reload is not in the registry, so its paints are dropped
+    // instead of being staged for an upload nothing would draw
+    shadow_frame_->async_output = async_;
+    
+    shadow_browser_ = BrowserPool::GetInstance()->Checkout(shadow_frame_, url_, width_, height_);
+    if (!shadow_browser_) {
+        shadow_browser_ = std::make_unique<CEFBrowser>(shadow_frame_);
+        if (!shadow_browser_->Initialize(url_, width_, height_)) {
+            shadow_browser_.reset();
+            shadow_frame_.reset();
+            return false;
+        }
+    }
+    
+    shadow_started_ns_ = os_gettime_ns();
+    if (render_scale_ != 1.0f) {
+        shadow_browser_->SetDeviceScale(render_scale_);
+    }
+    ApplyRenderTier();
+    return true;
+}
+
+void ChromiumSourceImpl::CancelShadowBrowser() {
+    if (shadow_browser_) {
+        shadow_browser_->SetSource(nullptr);
+        shadow_browser_->Close();
+        shadow_browser_.reset();
+    }
+    shadow_frame_.reset();
+}
+
+void ChromiumSourceImpl::PromoteShadowBrowser() {
+    if (!shadow_frame_->page_loaded || !shadow_frame_->painted_since_load) {
+        if (os_gettime_ns() - shadow_started_ns_ > SHADOW_RELOAD_TIMEOUT_NS) {
+            blog(LOG_WARNING, "[Chromium Source] Shadow reload timed out, keeping current page");
+            CancelShadowBrowser();
+        }
+        return;
+    }
+    
+    // Detach the old page first so its paints stop reaching the frame,
+    // then trade places under the scheduler's lock; snapshot copies and
+    // upload passes see either page, never half a swap
+    browser_->SetSource(nullptr);
+    UploadScheduler::GetInstance()->SwapFrames(frame_.get(), shadow_frame_.get());
+    shadow_browser_->SetSource(frame_);
+    
+    frame_->page_loaded = true;
+    frame_->painted_since_load = true;
+    frame_->health.Reset(os_gettime_ns());
+    frame_->alerts.Reset();
+    render_cache_valid_ = false;
+    frame_->health.RecordLoadEnd(os_gettime_ns());
+    frame_->navigation_ns = shadow_frame_->navigation_ns.load();
+    
+    // Retire the old page; its renderer is not reused
+    std::unique_ptr<CEFBrowser> old_browser = std::move(browser_);
+    browser_ = std::move(shadow_browser_);
+    old_browser->Close();
+    
+    // The new page's paints so far were dropped; an async source needs
+    // it painted again
+    if (async_) {
+        browser_->Invalidate();
+    }
+    
+    // The new page runs in another renderer; its trend starts over
+    MemoryWatchdog::GetInstance()->ResetFrame(frame_.get());
+    
+    // Frees the previous page's texture, or lets the last late callback
+    // of the old browser do it
+    shadow_frame_.reset();
+    
+    uint64_t now_ns = os_gettime_ns();
+    blog(LOG_INFO, "[Chromium Source] Reload swapped in after %.1f ms",
+         (now_ns - shadow_started_ns_) / 1000000.0);
+    
+    // The replacement also stands in for a crashed renderer
+    respawn_pending_ = false;
+    if (recovering_since_ns_) {
+        uint64_t recovery_ns = now_ns - recovering_since_ns_;
+        blog(recovery_ns > CRASH_RECOVERY_BUDGET_NS ? LOG_WARNING : LOG_INFO,
+             "[Chromium Source] '%s' recovered from renderer crash in %.1f ms (budget %.0f ms)",
+             obs_source_get_name(obs_source_), recovery_ns / 1000000.0,
+             CRASH_RECOVERY_BUDGET_NS / 1000000.0);
+        recovering_since_ns_ = 0;
+    }
+}
+
+void ChromiumSourceImpl::CheckHealth(uint64_t now_ns) {
+    // A reload in progress will replace whatever is failing; a browser
+    // still being created has nothing to report yet
+    if (!browser_ || shadow_browser_ || browser_->IsCreating()) {
+        return;
+    }
+    
+    // JS heartbeat: the page echoes the sequence number back via the console
+    uint32_t seq = frame_->health.NextHeartbeat(now_ns);
+    if (seq) {
+        browser_->ExecuteJavaScript("console.log('" HEALTH_HEARTBEAT_PREFIX "" + std::to_string(seq) + "');");
+    }
+    
+    HealthState state = frame_->health.Evaluate(now_ns, force_continuous_playback_ && tier_ != RenderTier::Hidden);
+    if (state != health_state_) {
+        HealthSnapshot snapshot = frame_->health.GetSnapshot(now_ns);
+        blog(state == HealthState::Failed ? LOG_WARNING : LOG_INFO,
+             "[Chromium Source] '%s' health: %s -> %s%s%s",
+             obs_source_get_name(obs_source_), BrowserHealth::StateName(health_state_),
+             BrowserHealth::StateName(state), snapshot.reason.empty() ? "" : ", ",
+             snapshot.reason.c_str());
+        health_state_ = state;
+    }
+    
+    // Crashes are left to HandleRendererCrash so its loop limiter holds
+    if (state == HealthState::Failed && auto_reload_ && reload_policy_ == RELOAD_POLICY_HEALTH &&
+        !respawn_pending_ && frame_->health.ConsumeReload(now_ns)) {
+        ReloadBrowser();
+    }
+}
+
+void ChromiumSourceImpl::HandleRendererCrash(uint64_t now_ns) {
+    bool crashed = frame_->renderer_crashed.exchange(false);
+    
+    if (shadow_frame_ && shadow_frame_->renderer_crashed.exchange(false)) {
+        blog(LOG_WARNING, "[Chromium Source] Replacement renderer crashed before painting");
+        CancelShadowBrowser();
+        crashed = true;
+    }
+    
+    if (crashed) {
+        if (!recovering_since_ns_) {
+            recovering_since_ns_ = now_ns;
+        }
+        
+        crash_times_.push_back(now_ns);
+        while (!crash_times_.empty() && now_ns - crash_times_.front() > CRASH_LOOP_WINDOW_NS) {
+            crash_times_.pop_front();
+        }
+        
+        // Crash loop: stop respawning for a while and keep the last frame
+        if (crash_times_.size() >= CRASH_LOOP_LIMIT) {
+            crash_cooldown_until_ns_ = now_ns + CRASH_LOOP_COOLDOWN_NS;
+            crash_times_.clear();
+            blog(LOG_ERROR, "[Chromium Source] '%s' renderer crashed %d times within %.0f s, "
+                 "pausing restarts for %.0f s", obs_source_get_name(obs_source_), CRASH_LOOP_LIMIT,
+                 CRASH_LOOP_WINDOW_NS / 1000000000.0, CRASH_LOOP_COOLDOWN_NS / 1000000000.0);
+        }
+        
+        respawn_pending_ = true;
+    }
+    
+    // A reload already underway will replace the crashed browser
+    if (!respawn_pending_ || shadow_browser_ || now_ns < crash_cooldown_until_ns_) {
+        return;
+    }
+    
+    // Hot standby: the last good frame stays up until the new page paints
+    blog(LOG_WARNING, "[Chromium Source] '%s' renderer terminated, starting replacement",
+         obs_source_get_name(obs_source_));
+    if (StartShadowBrowser()) {
+        respawn_pending_ = false;
+    }
+}
+
+// Largest on-canvas scale of any visible scene item showing one of the sources
+struct DisplayScan {
+    std::vector<obs_source_t*> sources;
+    std::vector<std::string> names;
+    float scale;
+    bool region_view;
+};
+
+static bool scan_scene_item(obs_scene_t* scene, obs_sceneitem_t* item, void* param) {
+    UNUSED_PARAMETER(scene);
+    DisplayScan* scan = static_cast<DisplayScan*>(param);
+    
+    if (obs_sceneitem_is_group(item)) {
+        obs_sceneitem_group_enum_items(item, scan_scene_item, param);
+        return true;
+    }
+    
+    obs_source_t* source = obs_sceneitem_get_source(item);
+    if (!obs_sceneitem_visible(item) ||
+        std::find(scan->sources.begin(), scan->sources.end(), source) == scan->sources.end()) {
+        return true;
+    }
+    
+    float width = (float)obs_source_get_width(source);
+    float height = (float)obs_source_get_height(source);
+    if (width <= 0.0f || height <= 0.0f) {
+        return true;
+    }
+    
+    struct vec2 scale;
+    if (obs_sceneitem_get_bounds_type(item) != OBS_BOUNDS_NONE) {
+        struct vec2 bounds;
+        obs_sceneitem_get_bounds(item, &bounds);
+        scale.x = bounds.x / width;
+        scale.y = bounds.y / height;
+    } else {
+        obs_sceneitem_get_scale(item, &scale);
+    }
+    
+    scan->scale = std::max(scan->scale, std::max(std::fabs(scale.x), std::fabs(scale.y)));
+    return true;
+}
+
+static bool scan_scene(void* param, obs_source_t* scene_source) {
+    obs_scene_t* scene = obs_scene_from_source(scene_source);
+    if (scene) {
+        obs_scene_enum_items(scene, scan_scene_item, param);
+    }
+    return true;
+}
+
+// Region views crop page pixels, so their parent has to stay at full size
+static bool scan_region_view(void* param, obs_source_t* source) {
+    DisplayScan* scan = static_cast<DisplayScan*>(param);
+    
+    const char* id = obs_source_get_unversioned_id(source);
+    if (!id || strcmp(id, REGION_VIEW_SOURCE_ID) != 0) {
+        return true;
+    }
+    
+    obs_data_t* settings = obs_source_get_settings(source);
+    const char* parent = obs_data_get_string(settings, PROP_REGION_PARENT);
+    if (parent && std::find(scan->names.begin(), scan->names.end(), parent) != scan->names.end()) {
+        scan->region_view = true;
+    }
+    obs_data_release(settings);
+    
+    return !scan->region_view;
+}
+
+float ChromiumSourceImpl::GetDisplayedScale() const {
+    DisplayScan scan;
+    scan.sources = BrowserRegistry::GetInstance()->GetSources(this);
+    scan.scale = 0.0f;
+    scan.region_view = false;
+    
+    for (obs_source_t* source : scan.sources) {
+        scan.names.push_back(obs_source_get_name(source));
+    }
+    
+    obs_enum_sources(scan_region_view, &scan);
+    if (scan.region_view) {
+        return 1.0f;
+    }
+    
+    obs_enum_scenes(scan_scene, &scan);
+    return scan.scale;
+}
+
+void ChromiumSourceImpl::CheckRenderScale(uint64_t now_ns) {
+    if (!browser_) {
+        return;
+    }
+    
+    // Auto resolution scales down further from the configured render scale
+    float target = render_scale_percent_ / 100.0f;
+    if (auto_resolution_) {
+        if (now_ns - auto_res_checked_ns_ < AUTO_RES_CHECK_INTERVAL_NS) {
+            return;
+        }
+        auto_res_checked_ns_ = now_ns;
+        
+        // Not placed in any scene: keep whatever we have
+        float displayed = GetDisplayedScale();
+        if (displayed <= 0.0f) {
+            return;
+        }
+        
+        // Round up to a step so small transform tweaks do not resize the view
+        float fit = std::ceil(displayed / AUTO_RES_STEP) * AUTO_RES_STEP;
+        target *= std::clamp(fit, AUTO_RES_MIN_SCALE, 1.0f);
+    }
+    
+    if (target == render_scale_) {
+        auto_res_shrink_since_ns_ = 0;
+        return;
+    }
+    
+    // Grow at once so the picture is never blurry; shrink only once the
+    // item has stayed clearly smaller for a while. A changed setting
+    // applies right away.
+    if (target > render_scale_ || !auto_resolution_) {
+        auto_res_shrink_since_ns_ = 0;
+    } else if (target < render_scale_ * AUTO_RES_SHRINK_RATIO) {
+        if (!auto_res_shrink_since_ns_) {
+            auto_res_shrink_since_ns_ = now_ns;
+        }
+        if (now_ns - auto_res_shrink_since_ns_ < AUTO_RES_SHRINK_DELAY_NS) {
+            return;
+        }
+        auto_res_shrink_since_ns_ = 0;
+    } else {
+        auto_res_shrink_since_ns_ = 0;
+        return;
+    }
+    
+    blog(LOG_INFO, "[Chromium Source] '%s' render scale %.3f -> %.3f (%dx%d painted at %dx%d)",
+         obs_source_get_name(obs_source_), render_scale_, target, width_, height_,
+         (int)std::lround(width_ * target), (int)std::lround(height_ * target));
+    
+    render_scale_ = target;
+    browser_->SetDeviceScale(target);
+    if (shadow_browser_) {
+        shadow_browser_->SetDeviceScale(target);
+    }
+}
+
+void ChromiumSourceImpl::CheckIdleRelease(uint64_t now_ns) {
+    uint64_t grace_ns = IdleReleaser::GetInstance()->GetGraceNs();
+    if (!frame_ || async_ || !grace_ns || tier_ != RenderTier::Hidden) {
+        hidden_since_ns_ = 0;
+        return;
+    }
+    if (!hidden_since_ns_) {
+        hidden_since_ns_ = now_ns;
+        return;
+    }
+    if (now_ns - hidden_since_ns_ < grace_ns) {
+        return;
+    }
+    
+    // Also catches paints that arrived after an earlier release
+    if (!UploadScheduler::GetInstance()->GetResidentBytes(frame_.get())) {
+        return;
+    }
+    
+    uint64_t released_cache = 0;
+    if (render_cache_) {
+        obs_enter_graphics();
+        gs_texrender_destroy(render_cache_);
+        obs_leave_graphics();
+        render_cache_ = nullptr;
+        render_cache_valid_ = false;
+        released_cache = (uint64_t)GetWidth() * GetHeight() * 4;
+    }
+    
+    if (!IdleReleaser::GetInstance()->Release(frame_.get(), thumbnail_)) {
+        return;
+    }
+    released_bytes_ = thumbnail_.released_bytes + released_cache;
+    thumbnail_bytes_ = thumbnail_.data.size();
+    frame_released_ = true;
+    
+    blog(LOG_INFO, "[Chromium Source] '%s' hidden for %.0f s, released %.1f MB of frame memory",
+         obs_source_get_name(obs_source_), (now_ns - hidden_since_ns_) / 1000000000.0,
+         released_bytes_ / (1024.0 * 1024.0));
+}
+
+void ChromiumSourceImpl::RestoreReleasedFrame() {
+    if (!frame_released_) {
+        return;
+    }
+    IdleReleaser::GetInstance()->Restore(frame_.get(), thumbnail_);
+    frame_released_ = false;
+}
+
+void ChromiumSourceImpl::CheckMemory(uint64_t now_ns) {
+    if (memory_limit_mb_ <= 0 || !browser_ || shadow_browser_ ||
+        now_ns - memory_checked_ns_ < MEMORY_CHECK_INTERVAL_NS) {
+        return;
+    }
+    memory_checked_ns_ = now_ns;
+    
+    RendererMemory usage;
+    if (!MemoryWatchdog::GetInstance()->GetUsage(frame_.get(), usage) ||
+        usage.pss_kb / 1024 <= (uint64_t)memory_limit_mb_) {
+        return;
+    }
+    
+    // A renderer shared with other sources would survive the recycle
+    if (usage.shared) {
+        if (!memory_shared_warned_) {
+            blog(LOG_WARNING, "[Chromium Source] '%s' renderer %d is over %d MB but shared with other sources, not recycling",
+                 obs_source_get_name(obs_source_), usage.pid, memory_limit_mb_);
+            memory_shared_warned_ = true;
+        }
+        return;
+    }
+    
+    if (memory_recycled_ns_ && now_ns - memory_recycled_ns_ < MEMORY_RECYCLE_COOLDOWN_NS) {
+        return;
+    }
+    
+    blog(LOG_WARNING, "[Chromium Source] '%s' renderer %d at %.1f MB PSS exceeds %d MB limit, recycling browser",
+         obs_source_get_name(obs_source_), usage.pid, usage.pss_kb / 1024.0, memory_limit_mb_);
+    
+    // Seamless: the current page stays up until the fresh one paints
+    memory_recycled_ns_ = now_ns;
+    StartShadowBrowser();
+}
+
+uint64_t ChromiumSourceImpl::GetRedundantDrawsAvoided() const {
+    return redundant_draws_avoided_;
+}
+
+std::string ChromiumSourceImpl::GetMemorySummary() const {
+    RendererMemory usage;
+    if (frame_ && MemoryWatchdog::GetInstance()->IsUnattributed(frame_.get())) {
+        return "unknown (renderer not told apart from other sources, no recycling)";
+    }
+    if (!frame_ || !MemoryWatchdog::GetInstance()->GetUsage(frame_.get(), usage)) {
+        return "not available";
+    }
+    
+    char buffer[192];
+    snprintf(buffer, sizeof(buffer), "PSS %.1f MB | RSS %.1f MB | trend %+.1f MB/h | CPU %.1f%% | pid %d%s",
+             usage.pss_kb / 1024.0, usage.rss_kb / 1024.0, usage.trend_mb_per_hour, usage.cpu_percent,
+             usage.pid, usage.shared ? " (shared)" : "");
+    return buffer;
+}
+
+std::string ChromiumSourceImpl::GetBlockedSummary() const {
+    if (!frame_) {
+        return "not available";
+    }
+    
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "%llu trackers and analytics | ~%.1f s renderer CPU saved",
+             (unsigned long long)frame_->blocked_requests.load(), frame_->blocked_cost_us / 1000000.0);
+    return buffer;
+}
+
+std::string ChromiumSourceImpl::GetResidentSummary() const {
+    if (!frame_) {
+        return "not available";
+    }
+    
+    char buffer[128];
+    if (frame_released_) {
+        snprintf(buffer, sizeof(buffer), "%.1f MB released while hidden | %.0f KB thumbnail kept",
+                 released_bytes_ / (1024.0 * 1024.0), thumbnail_bytes_ / 1024.0);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.1f MB in texture and paint buffers",
+                 UploadScheduler::GetInstance()->GetResidentBytes(frame_.get()) / (1024.0 * 1024.0));
+    }
+    return buffer;
+}
+
+void ChromiumSourceImpl::SimulateRendererCrash() {
+    if (browser_ && browser_->IsValid()) {
+        blog(LOG_INFO, "[Chromium Source] Crashing renderer to test recovery");
+        browser_->LoadURL(CRASH_TEST_URL);
+    }
+}
+
+std::string ChromiumSourceImpl::GetHealthSummary() const {
+    if (!frame_) {
+        return "not available";
+    }
+    
+    HealthSnapshot snapshot = frame_->health.GetSnapshot(os_gettime_ns());
+    
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+             "%s%s%s | last paint %.1f s ago | heartbeat %.0f ms | load errors %u | crashes %u | reloads %u (backoff %.0f s)",
+             BrowserHealth::StateName(snapshot.state), snapshot.reason.empty() ? "" : ": ",
+             snapshot.reason.c_str(), snapshot.since_paint_ms / 1000.0, snapshot.heartbeat_rtt_ms,
+             snapshot.recent_load_errors, snapshot.renderer_crashes, snapshot.health_reloads,
+             snapshot.backoff_s);
+    
+    std::string summary = buffer;
+    
+    AlertSnapshot alerts = frame_->alerts.GetSnapshot();
+    if (alerts.alerts > 0 || alerts.declared) {
+        snprintf(buffer, sizeof(buffer), " | alerts %u%s%s | bridge latency %.1f ms (avg %.1f ms)",
+                 alerts.alerts, alerts.active ? " (playing)" : "", alerts.declared ? ", page driven" : "",
+                 alerts.last_latency_ms, alerts.avg_latency_ms);
+        summary += buffer;
+    }
+    
+    size_t shared = BrowserRegistry::GetInstance()->GetShareCount(this);
+    if (shared > 1) {
+        summary += " | shared by " + std::to_string(shared) + " sources";
+    }
+    return summary;
+}
+
 // Property modification callbacks
 namespace ChromiumSourceProperties {
 
@@ -372,7 +1711,7 @@ bool reload_button_clicked(obs_properties_t* props, obs_property_t* property, vo
     
     if (data) {
         ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(data);
-        impl->ReloadBrowser();
+        impl->RequestReload();
     }
     
     return false; // Don't refresh properties
@@ -430,12 +1769,40 @@ bool auto_reload_modified(obs_properties_t* props, obs_property_t* property, obs
     UNUSED_PARAMETER(property);
     
     bool auto_reload = obs_data_get_bool(settings, PROP_AUTO_RELOAD);
+    bool interval = obs_data_get_int(settings, PROP_RELOAD_POLICY) == RELOAD_POLICY_INTERVAL;
     
-    // Show/hide reload interval control
+    // Show/hide reload policy and interval controls
+    obs_property_t* policy_prop = obs_properties_get(props, PROP_RELOAD_POLICY);
     obs_property_t* interval_prop = obs_properties_get(props, PROP_RELOAD_INTERVAL);
-    obs_property_set_visible(interval_prop, auto_reload);
+    obs_property_set_visible(policy_prop, auto_reload);
+    obs_property_set_visible(interval_prop, auto_reload && interval);
     
     return true;
 }
 
+bool prefetch_mode_modified(obs_properties_t* props, obs_property_t* property, obs_data_t* settings) {
+    UNUSED_PARAMETER(property);
+    
+    bool manifest = obs_data_get_int(settings, PROP_PREFETCH_MODE) == PREFETCH_MODE_MANIFEST;
+    obs_property_set_visible(obs_properties_get(props, PROP_PREFETCH_MANIFEST), manifest);
+    
+    return true;
+}
+
+bool crash_test_button_clicked(obs_properties_t* props, obs_property_t* property, void* data) {
+    UNUSED_PARAMETER(props);
+    UNUSED_PARAMETER(property);
+    
+    if (data) {
+        ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(data);
+        impl->RequestCrashTest();
+    }
+    
+    return false;
+}
+
+bool reload_policy_modified(obs_properties_t* props, obs_property_t* property, obs_data_t* settings) {
+    return auto_reload_modified(props, property, settings);
+}
+
 } // namespace ChromiumSourceProperties
\ No newline at end of file
@@ -1,12 +1,19 @@
 #pragma once
 
 #include "plugin.h"
+#include "browser_registry.h"
+#include "cef_browser.h"
+#include "fused_effect.h"
+#include "asset_prefetch.h"
+#include "idle_release.h"
 #include <obs-module.h>
 #include <obs-properties.h>
 #include <graphics/graphics.h>
 #include <util/threading.h>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <deque>
 
 // Forward declarations
 class CEFBrowser;
@@ -29,7 +36,10 @@ public:
     bool Initialize(obs_data_t* settings);
     
     /**
-     * Update source settings.
+     * Update source settings. Volume and mute apply at once; everything
+     * else waits until the settings have been quiet for SETTINGS_QUIET_NS,
+     * so typing a URL or dragging a size slider only navigates or resizes
+     * once.
      */
     void Update(obs_data_t* settings);
     
@@ -44,12 +54,29 @@ public:
     void VideoRender(gs_effect_t* effect);
     
     /**
-     * Get the source width.
+     * Draw a sub-rectangle of the current frame, for region views. The
+     * rectangle is clipped to the page.
+     */
+    void RenderRegion(gs_effect_t* effect, int x, int y, int width, int height);
+    
+    /**
+     * Visibility callbacks. They record where the source is shown; the
+     * next VideoTick counts it into the shared frame and moves the browser
+     * between render tiers before the frame is drawn, so a scene switch
+     * shows the page on its first frame.
+     */
+    void Activate();
+    void Deactivate();
+    void Show();
+    void Hide();
+    
+    /**
+     * Get the source width, after crop.
      */
     uint32_t GetWidth() const;
     
     /**
-     * Get the source height.
+     * Get the source height, after crop.
      */
     uint32_t GetHeight() const;
     
@@ -63,9 +90,68 @@ public:
      */
     obs_source_t* GetSource() const;
     
+    /**
+     * Reload the page without blanking the output. A shadow browser loads
+     * the same URL in the background and replaces the live one once it
+     * has painted its first frame. Safe from any thread, e.g. the
+     * properties button; the source that owns the browser starts the
+     * reload on its next VideoTick.
+     */
+    void RequestReload();
+    
+    /**
+     * Deliberately crash the renderer to exercise crash recovery. Like
+     * RequestReload, carried out by the owner's next VideoTick.
+     */
+    void RequestCrashTest();
+    
+    /**
+     * Get a one-line description of the browser's health for display.
+     */
+    std::string GetHealthSummary() const;
+    
+    /**
+     * Get a one-line description of the renderer's memory use for display.
+     */
+    std::string GetMemorySummary() const;
+    
+    /**
+     * Get a one-line summary of the requests the blocker cancelled for
+     * this source's page.
+     */
+    std::string GetBlockedSummary() const;
+    
+    /**
+     * Get a one-line description of the frame memory the source holds, or
+     * gave up while hidden, for display.
+     */
+    std::string GetResidentSummary() const;
+    
+    /**
+     * Number of draws served from the per-frame render cache instead of
+     * drawing the page again.
+     */
+    uint64_t GetRedundantDrawsAvoided() const;
+    
+    /**
+     * Take over the browser of an identical source that went away. Picked
+     * up on the next VideoTick; nullptr means the browser still has to be
+     * created.
+     */
+    void AdoptBrowser(std::unique_ptr<CEFBrowser> browser);
+    
+    /**
+     * Move the browser between render tiers to match where the sources
+     * sharing it are shown. Called on the source owning the browser.
+     */
+    void ApplyRenderTier();
+    
 private:
     obs_source_t* obs_source_;
     
+    // Registered as the async source type: paints go to OBS's frame queue
+    bool async_;
+    
     // Browser management
     std::unique_ptr<CEFBrowser> browser_;
     std::unique_ptr<CEFAudio> audio_;
@@ -75,24 +161,133 @@ private:
     int width_;
     int height_;
     bool force_continuous_playback_;
+    bool idle_on_program_;
+    bool auto_resolution_;
+    int render_scale_percent_;
+    int upscale_filter_;
+    
+    // Built-in effects; crop is in page pixels
+    FusedEffect fused_effect_;
+    FusedEffectSettings effect_settings_;
+    int crop_left_;
+    int crop_top_;
+    int crop_right_;
+    int crop_bottom_;
     float volume_;
     bool muted_;
     bool auto_reload_;
+    int memory_limit_mb_;
+    int reload_policy_;
     int reload_interval_;
+    int prefetch_mode_;
+    std::vector<std::string> prefetch_manifest_;
     
-    // Rendering
-    gs_texture_t* texture_;
-    pthread_mutex_t texture_mutex_;
+    // Rendering target the browser paints into, shared with identical sources
+    std::shared_ptr<ChromiumSource> frame_;
+    BrowserKey key_;
+    bool owns_browser_;
+    
+    // Where this source is shown, set from the OBS callbacks, and what
+    // VideoTick has counted into the shared frame so far
+    std::atomic<bool> active_;
+    std::atomic<bool> showing_;
+    bool counted_active_;
+    bool counted_showing_;
+    RenderTier tier_;
+    
+    // Browser handed over by a departing owner
+    std::mutex adopt_mutex_;
+    std::unique_ptr<CEFBrowser> adopted_browser_;
+    bool adopt_pending_;
+    
+    // Shadow browser loading in the background during a reload
+    std::unique_ptr<CEFBrowser> shadow_browser_;
+    std::shared_ptr<ChromiumSource> shadow_frame_;
+    uint64_t shadow_started_ns_;
     
     // Timing
     float last_reload_time_;
     
+    // Set while the browser is waiting for CEF to finish starting
+    bool browser_pending_;
+    
+    // Last health verdict, used to log transitions
+    HealthState health_state_;
+    
+    // Renderer crash recovery
+    std::deque<uint64_t> crash_times_;
+    uint64_t crash_cooldown_until_ns_;
+    uint64_t recovering_since_ns_;
+    bool respawn_pending_;
+    
+    // Renderer memory watchdog
+    uint64_t memory_checked_ns_;
+    uint64_t memory_recycled_ns_;
+    bool memory_shared_warned_;
+    
+    // Fraction of the logical size the page is painted at: the render
+    // scale setting, further lowered by auto resolution
+    float render_scale_;
+    uint64_t auto_res_checked_ns_;
+    uint64_t auto_res_shrink_since_ns_;
+    
+    // Output of the first draw in a frame, reused by later draws in it
+    gs_texrender_t* render_cache_;
+    bool render_cache_valid_;
+    bool use_render_cache_;
+    uint64_t render_frame_time_;
+    uint32_t render_frame_draws_;
+    std::atomic<uint64_t> redundant_draws_avoided_;
+    
+    // Latest settings from Update, applied from VideoTick once they stop changing
+    std::mutex settings_mutex_;
+    obs_data_t* pending_settings_;
+    uint64_t pending_since_ns_;
+    uint32_t pending_updates_;
+    
+    // Deleted by the user; no snapshot is kept
+    bool removed_;
+    
+    // SOURCE_REQUEST_* bits set from the UI thread, consumed by VideoTick
+    std::atomic<int> requests_;
+    
+    // Frame memory given back while nobody is looking, restored from the
+    // thumbnail when the page is shown again; only used from VideoTick
+    uint64_t hidden_since_ns_;
+    FrameThumbnail thumbnail_;
+    std::atomic<bool> frame_released_;
+    std::atomic<uint64_t> released_bytes_;
+    std::atomic<uint64_t> thumbnail_bytes_;
+    
     // Helper methods
+    void MigrateSettings(obs_data_t* settings);
     void LoadSettings(obs_data_t* settings);
+    void ApplySettings(obs_data_t* settings);
+    void ApplyPendingSettings(uint64_t now_ns);
+    BrowserKey MakeKey() const;
+    void JoinRegistry();
+    void LeaveRegistry();
+    void SharePrefetch();
     void CreateBrowser();
     void DestroyBrowser();
+    bool CountVisibility();
     void UpdateBrowserSize();
     void ReloadBrowser();
+    void SimulateRendererCrash();
+    bool StartShadowBrowser();
+    void CancelShadowBrowser();
+    void PromoteShadowBrowser();
+    void CheckHealth(uint64_t now_ns);
+    void HandleRendererCrash(uint64_t now_ns);
+    void CheckMemory(uint64_t now_ns);
+    void CheckRenderScale(uint64_t now_ns);
+    void CheckIdleRelease(uint64_t now_ns);
+    void RestoreReleasedFrame();
+    void DrawFrame();
+    bool IsDrawExpensive() const;
+    bool RenderToCache();
+    float GetDisplayedScale() const;
+    static void OnSourceRemoved(void* data, calldata_t* calldata);
 };
 
 /**
@@ -128,6 +323,24 @@ namespace ChromiumSourceProperties {
      */
     bool auto_reload_modified(obs_properties_t* props, obs_property_t* property,
                              obs_data_t* settings);
+    
+    /**
+     * Prefetch mode selection callback.
+     */
+    bool prefetch_mode_modified(obs_properties_t* props, obs_property_t* property,
+                               obs_data_t* settings);
+    
+    /**
+     * Crash test button callback.
+     */
+    bool crash_test_button_clicked(obs_properties_t* props, obs_property_t* property,
+                                  void* data);
+    
+    /**
+     * Reload policy selection callback.
+     */
+    bool reload_policy_modified(obs_properties_t* props, obs_property_t* property,
+                               obs_data_t* settings);
 }
 
 /**
@@ -164,12 +377,51 @@ static const SizePreset SIZE_PRESETS[] = {
 #define PROP_SIZE_PRESET "size_preset"
 #define PROP_CUSTOM_SIZE "custom_size"
 #define PROP_FORCE_CONTINUOUS "force_continuous"
+#define PROP_IDLE_ON_PROGRAM "idle_on_program"
+#define PROP_AUTO_RESOLUTION "auto_resolution"
+#define PROP_RENDER_SCALE "render_scale"
+#define PROP_UPSCALE_FILTER "upscale_filter"
 #define PROP_VOLUME "volume"
 #define PROP_MUTED "muted"
 #define PROP_AUTO_RELOAD "auto_reload"
+#define PROP_RELOAD_POLICY "reload_policy"
+#define PROP_HEALTH_INFO "health_info"
+#define PROP_CRASH_TEST_BUTTON "crash_test_button"
+#define PROP_MEMORY_LIMIT "memory_limit"
+#define PROP_MEMORY_INFO "memory_info"
+#define PROP_UPLOAD_INFO "upload_info"
+#define PROP_TEXTURE_POOL_INFO "texture_pool_info"
+#define PROP_RENDER_CACHE_INFO "render_cache_info"
+#define PROP_ASSET_CACHE_INFO "asset_cache_info"
+#define PROP_BLOCKED_INFO "blocked_info"
+#define PROP_RESIDENT_INFO "resident_info"
 #define PROP_RELOAD_INTERVAL "reload_interval"
 #define PROP_RELOAD_BUTTON "reload_button"
 #define PROP_ADVANCED_GROUP "advanced_group"
+#define PROP_EFFECTS_GROUP "effects_group"
+#define PROP_KEY_MODE "key_mode"
+#define PROP_KEY_COLOR "key_color"
+#define PROP_KEY_SIMILARITY "key_similarity"
+#define PROP_KEY_SMOOTHNESS "key_smoothness"
+#define PROP_OPACITY "opacity"
+#define PROP_CROP_LEFT "crop_left"
+#define PROP_CROP_TOP "crop_top"
+#define PROP_CROP_RIGHT "crop_right"
+#define PROP_CROP_BOTTOM "crop_bottom"
+#define PROP_PREFETCH_MODE "prefetch_mode"
+#define PROP_PREFETCH_MANIFEST "prefetch_manifest"
+
+/**
+ * Filters used to scale a reduced render back up to the logical size.
+ */
+#define UPSCALE_FILTER_BILINEAR 0
+#define UPSCALE_FILTER_BICUBIC 1
+
+/**
+ * Automatic reload policies.
+ */
+#define RELOAD_POLICY_HEALTH 0    // reload on evidence of failure, with backoff
+#define RELOAD_POLICY_INTERVAL 1  // reload every reload_interval seconds
 
 /**
  * Default property values.
@@ -177,7 +429,17 @@ static const SizePreset SIZE_PRESETS[] = {
 #define DEFAULT_SIZE_PRESET 1  // 1920x1080
 #define DEFAULT_CUSTOM_SIZE false
 #define DEFAULT_AUTO_RELOAD false
+#define DEFAULT_IDLE_ON_PROGRAM false
+#define DEFAULT_AUTO_RESOLUTION false
+#define DEFAULT_RENDER_SCALE 100  // percent
+#define DEFAULT_UPSCALE_FILTER UPSCALE_FILTER_BILINEAR
+#define DEFAULT_KEY_COLOR 0xFF00FF00  // green, 0xAABBGGRR
+#define DEFAULT_KEY_SIMILARITY 400    // per mille, as in OBS's chroma key
+#define DEFAULT_KEY_SMOOTHNESS 80
+#define DEFAULT_RELOAD_POLICY RELOAD_POLICY_HEALTH
+#define DEFAULT_MEMORY_LIMIT 0  // MB, 0 disables recycling
 #define DEFAULT_RELOAD_INTERVAL 300  // 5 minutes
+#define DEFAULT_PREFETCH_MODE PREFETCH_MODE_OFF
 
 /**
  * Property constraints.
@@ -188,6 +450,44 @@ static const SizePreset SIZE_PRESETS[] = {
 #define MAX_HEIGHT 4320
 #define MIN_RELOAD_INTERVAL 10   // 10 seconds
 #define MAX_RELOAD_INTERVAL 3600 // 1 hour
+#define MIN_RENDER_SCALE 25      // percent
+#define SHADOW_RELOAD_TIMEOUT_NS 30000000000ULL // 30 seconds
+
+/**
+ * Renderer crash recovery limits.
+ */
+#define CRASH_LOOP_LIMIT 3                          // crashes within the window
+#define CRASH_LOOP_WINDOW_NS 120000000000ULL        // 2 minutes
+#define CRASH_LOOP_COOLDOWN_NS 300000000000ULL      // 5 minutes without restarts
+#define CRASH_RECOVERY_BUDGET_NS 3000000000ULL      // crash to first new frame
+#define CRASH_TEST_URL "chrome://crash"
+
+/**
+ * Requests from the properties, carried out by the browser's owner.
+ */
+#define SOURCE_REQUEST_RELOAD 1
+#define SOURCE_REQUEST_CRASH_TEST 2
+
+/**
+ * Settings changes.
+ */
+#define SETTINGS_QUIET_NS 300000000ULL              // 0.3 seconds without updates
+
+/**
+ * Auto resolution.
+ */
+#define AUTO_RES_MIN_SCALE 0.25f
+#define AUTO_RES_STEP 0.125f                        // scale granularity
+#define AUTO_RES_SHRINK_RATIO 0.8f                  // shrink only below 80% of current
+#define AUTO_RES_SHRINK_DELAY_NS 3000000000ULL      // 3 seconds
+#define AUTO_RES_CHECK_INTERVAL_NS 500000000ULL     // 0.5 seconds
+
+/**
+ * Renderer memory recycling.
+ */
+#define MAX_MEMORY_LIMIT 16384                      // MB
+#define MEMORY_CHECK_INTERVAL_NS 1000000000ULL      // 1 second
+#define MEMORY_RECYCLE_COOLDOWN_NS 600000000000ULL  // 10 minutes
 
 /**
  * Localization text keys.
@@ -204,12 +504,59 @@ static const SizePreset SIZE_PRESETS[] = {
 #define TEXT_HEIGHT_TOOLTIP "Browser viewport height in pixels"
 #define TEXT_FORCE_CONTINUOUS "Force Continuous Playback"
 #define TEXT_FORCE_CONTINUOUS_TOOLTIP "Keep browser active even when source is hidden"
+#define TEXT_IDLE_ON_PROGRAM "Idle Between Alerts On Program"
+#define TEXT_IDLE_ON_PROGRAM_TOOLTIP "Pages that call the alert bridge themselves drop to the idle frame rate between alerts even while on Program; animations between alerts become choppy"
+#define TEXT_AUTO_RESOLUTION "Auto Resolution"
+#define TEXT_AUTO_RESOLUTION_TOOLTIP "Paint the page at the largest size it is shown at in any scene instead of its full size; the page layout stays the same"
+#define TEXT_RENDER_SCALE "Render Scale"
+#define TEXT_RENDER_SCALE_TOOLTIP "Paint the page below its size and scale it up on the GPU; lowers CPU use with software rendering at the cost of sharpness"
+#define TEXT_UPSCALE_FILTER "Upscale Filter"
+#define TEXT_UPSCALE_FILTER_TOOLTIP "Filter used to scale a reduced render back up"
+#define TEXT_UPSCALE_FILTER_BILINEAR "Bilinear"
+#define TEXT_UPSCALE_FILTER_BICUBIC "Bicubic"
+#define TEXT_EFFECTS_GROUP "Effects"
+#define TEXT_KEY_MODE "Key"
+#define TEXT_KEY_MODE_TOOLTIP "Make a key color transparent, in the same pass that draws the page"
+#define TEXT_KEY_MODE_NONE "None"
+#define TEXT_KEY_MODE_CHROMA "Chroma Key"
+#define TEXT_KEY_MODE_COLOR "Color Key"
+#define TEXT_KEY_COLOR "Key Color"
+#define TEXT_KEY_SIMILARITY "Similarity"
+#define TEXT_KEY_SMOOTHNESS "Smoothness"
+#define TEXT_OPACITY "Opacity"
+#define TEXT_CROP_LEFT "Crop Left"
+#define TEXT_CROP_TOP "Crop Top"
+#define TEXT_CROP_RIGHT "Crop Right"
+#define TEXT_CROP_BOTTOM "Crop Bottom"
 #define TEXT_VOLUME "Volume"
 #define TEXT_VOLUME_TOOLTIP "Audio volume level (0-100%)"
 #define TEXT_MUTED "Muted"
 #define TEXT_MUTED_TOOLTIP "Mute audio output"
 #define TEXT_AUTO_RELOAD "Auto Reload"
-#define TEXT_AUTO_RELOAD_TOOLTIP "Automatically reload the page at specified intervals"
+#define TEXT_AUTO_RELOAD_TOOLTIP "Automatically reload the page when it stops responding or at specified intervals"
+#define TEXT_RELOAD_POLICY "Reload Policy"
+#define TEXT_RELOAD_POLICY_TOOLTIP "Reload only when the page fails health checks, or on a fixed interval"
+#define TEXT_RELOAD_POLICY_HEALTH "When unhealthy"
+#define TEXT_RELOAD_POLICY_INTERVAL "Fixed interval"
+#define TEXT_PREFETCH_MODE "Prefetch Alert Media"
+#define TEXT_PREFETCH_MODE_TOOLTIP "Download the page's alert media into the asset cache after it loads, so the first alert does not wait for the network"
+#define TEXT_PREFETCH_MODE_OFF "Off"
+#define TEXT_PREFETCH_MODE_LEARNED "Learned from earlier sessions"
+#define TEXT_PREFETCH_MODE_MANIFEST "Manifest"
+#define TEXT_PREFETCH_MANIFEST "Prefetch Manifest"
+#define TEXT_PREFETCH_MANIFEST_TOOLTIP "Media URLs to prefetch, one per line"
+#define TEXT_HEALTH_INFO "Health"
+#define TEXT_MEMORY_LIMIT "Renderer Memory Limit (MB)"
+#define TEXT_MEMORY_LIMIT_TOOLTIP "Recycle the browser when its renderer process exceeds this much memory (0 = never, Linux only)"
+#define TEXT_MEMORY_INFO "Renderer Memory"
+#define TEXT_UPLOAD_INFO "Texture Uploads (all sources)"
+#define TEXT_TEXTURE_POOL_INFO "Texture Pool (all sources)"
+#define TEXT_RENDER_CACHE_INFO "Render Cache"
+#define TEXT_ASSET_CACHE_INFO "Alert Asset Cache (all sources)"
+#define TEXT_BLOCKED_INFO "Blocked Requests"
+#define TEXT_RESIDENT_INFO "Frame Memory"
+#define TEXT_CRASH_TEST_BUTTON "Test Crash Recovery"
+#define TEXT_CRASH_TEST_BUTTON_TOOLTIP "Crash the page's renderer process to check that the source recovers"
 #define TEXT_RELOAD_INTERVAL "Reload Interval (seconds)"
 #define TEXT_RELOAD_INTERVAL_TOOLTIP "Time between automatic reloads"
 #define TEXT_RELOAD_BUTTON "Reload Page"
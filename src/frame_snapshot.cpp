@@ -0,0 +1,209 @@
+#include "frame_snapshot.h"
+#include "upload_scheduler.h"
+#include "plugin.h"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t url_size;
+};
+
+} // namespace
+
+FrameSnapshotStore* FrameSnapshotStore::GetInstance() {
+    static FrameSnapshotStore instance;
+    return &instance;
+}
+
+FrameSnapshotStore::FrameSnapshotStore()
+    : enabled_(false)
+    , tearing_down_(false)
+    , saved_(0)
+    , restored_(0)
+    , removed_(0)
+    , raw_bytes_(0)
+    , stored_bytes_(0) {
+}
+
+void FrameSnapshotStore::Open() {
+    obs_data_t* config = ChromiumPlugin::GetInstance()->GetConfig();
+    if (!config || !obs_data_get_bool(config, CONFIG_FRAME_SNAPSHOTS)) {
+        blog(LOG_INFO, "[Frame Snapshot] Disabled");
+        return;
+    }
+    
+    char* directory = obs_module_config_path(SNAPSHOT_DIR);
+    if (!directory || os_mkdirs(directory) == MKDIR_ERROR) {
+        blog(LOG_WARNING, "[Frame Snapshot] Could not create the snapshot directory, snapshots disabled");
+        bfree(directory);
+        return;
+    }
+    directory_ = directory;
+    bfree(directory);
+    
+    // Sources removed while OBS tears everything down keep their snapshot
+    obs_frontend_add_event_callback(OnFrontendEvent, this);
+    enabled_ = true;
+}
+
+void FrameSnapshotStore::Close() {
+    if (!enabled_) {
+        return;
+    }
+    obs_frontend_remove_event_callback(OnFrontendEvent, this);
+    enabled_ = false;
+    LogStats();
+}
+
+bool FrameSnapshotStore::Restore(const char* uuid, const std::string& url, ChromiumSource* frame) {
+    if (!enabled_ || !uuid || !frame) {
+        return false;
+    }
+    
+    QFile file(QString::fromUtf8(GetPath(uuid).c_str()));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    qint64 size = file.size();
+    if (size < (qint64)sizeof(SnapshotHeader)) {
+        return false;
+    }
+    const uchar* data = file.map(0, size);
+    if (!data) {
+        return false;
+    }
+    
+    SnapshotHeader header;
+    memcpy(&header, data, sizeof(header));
+    uint64_t pixels = (uint64_t)header.width * header.height;
+    qint64 payload = (qint64)sizeof(header) + header.url_size;
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION ||
+        pixels == 0 || pixels > SNAPSHOT_MAX_PIXELS || payload >= size ||
+        url.compare(0, std::string::npos, reinterpret_cast<const char*>(data) + sizeof(header), header.url_size) != 0) {
+        file.unmap(const_cast<uchar*>(data));
+        return false;
+    }
+    
+    // Inflated straight out of the mapping
+    QByteArray compressed = QByteArray::fromRawData(reinterpret_cast<const char*>(data) + payload, (int)(size - payload));
+    QByteArray bgra = qUncompress(compressed);
+    file.unmap(const_cast<uchar*>(data));
+    if ((uint64_t)bgra.size() != pixels * 4) {
+        blog(LOG_WARNING, "[Frame Snapshot] Discarding damaged snapshot for %s", uuid);
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(frame->staging_mutex);
+        if (frame->staging_dirty) {
+            return false;
+        }
+        frame->staging.assign(bgra.constBegin(), bgra.constEnd());
+        frame->staging_width = (int)header.width;
+        frame->staging_height = (int)header.height;
+        frame->staging_dirty = true;
+    }
+    
+    restored_++;
+    blog(LOG_DEBUG, "[Frame Snapshot] Restored %ux%u frame for %s", header.width, header.height, uuid);
+    return true;
+}
+
+void FrameSnapshotStore::Save(const char* uuid, const std::string& url, ChromiumSource* frame) {
+    if (!enabled_ || !uuid || !frame) {
+        return;
+    }
+    
+    std::vector<uint8_t> bgra;
+    int width = 0;
+    int height = 0;
+    if (!UploadScheduler::GetInstance()->CopyLastFrame(frame, bgra, width, height)) {
+        return;
+    }
+    
+    QByteArray compressed = qCompress(reinterpret_cast<const uchar*>(bgra.data()), (int)bgra.size(), SNAPSHOT_COMPRESSION);
+    
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.width = (uint32_t)width;
+    header.height = (uint32_t)height;
+    header.url_size = (uint32_t)url.size();
+    
+    QSaveFile out(QString::fromUtf8(GetPath(uuid).c_str()));
+    if (!out.open(QIODevice::WriteOnly) ||
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header)) != (qint64)sizeof(header) ||
+        out.write(url.data(), (qint64)url.size()) != (qint64)url.size() ||
+        out.write(compressed) != compressed.size() ||
+        !out.commit()) {
+        blog(LOG_WARNING, "[Frame Snapshot] Could not write snapshot for %s", uuid);
+        return;
+    }
+    
+    saved_++;
+    raw_bytes_ += bgra.size();
+    stored_bytes_ += (uint64_t)compressed.size();
+}
+
+bool FrameSnapshotStore::Remove(const char* uuid) {
+    if (!enabled_ || !uuid || tearing_down_) {
+        return false;
+    }
+    
+    if (QFile::remove(QString::fromUtf8(GetPath(uuid).c_str()))) {
+        removed_++;
+    }
+    return true;
+}
+
+SnapshotStats FrameSnapshotStore::GetStats() const {
+    SnapshotStats stats;
+    stats.saved = saved_;
+    stats.restored = restored_;
+    stats.removed = removed_;
+    stats.raw_bytes = raw_bytes_;
+    stats.stored_bytes = stored_bytes_;
+    return stats;
+}
+
+void FrameSnapshotStore::LogStats() const {
+    SnapshotStats stats = GetStats();
+    
+    blog(LOG_INFO, "[Frame Snapshot] restored: %llu, saved: %llu (%.1f MB as %.1f MB), removed: %llu",
+         (unsigned long long)stats.restored, (unsigned long long)stats.saved,
+         stats.raw_bytes / (1024.0 * 1024.0), stats.stored_bytes / (1024.0 * 1024.0),
+         (unsigned long long)stats.removed);
+}
+
+std::string FrameSnapshotStore::GetPath(const char* uuid) const {
+    return directory_ + "/" + uuid + SNAPSHOT_EXTENSION;
+}
+
+void FrameSnapshotStore::OnFrontendEvent(enum obs_frontend_event event, void* param) {
+    FrameSnapshotStore* store = static_cast<FrameSnapshotStore*>(param);
+    
+    switch (event) {
+        case OBS_FRONTEND_EVENT_SCRIPTING_SHUTDOWN:
+        case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING:
+        case OBS_FRONTEND_EVENT_EXIT:
+            store->tearing_down_ = true;
+            break;
+        case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
+        case OBS_FRONTEND_EVENT_FINISHED_LOADING:
+            store->tearing_down_ = false;
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+// Forward declarations
+struct ChromiumSource;
+
+/**
+ * Counters describing snapshot use across all sources.
+ */
+struct SnapshotStats {
+    uint64_t saved;
+    uint64_t restored;
+    uint64_t removed;
+    uint64_t raw_bytes;        // pixels saved
+    uint64_t stored_bytes;     // after compression
+    
+    SnapshotStats()
+        : saved(0)
+        , restored(0)
+        , removed(0)
+        , raw_bytes(0)
+        , stored_bytes(0) {
+    }
+};
+
+/**
+ * Keeps the last frame of every source on disk so the next start can show
+ * it before the browser exists. A snapshot is written when the source is
+ * destroyed, compressed BGRA keyed by the source UUID, and staged as the
+ * frame's first paint when the source is created again; the first live
+ * paint replaces it. Snapshots of sources the user deletes are removed;
+ * sources torn down by OBS exiting or switching scene collections keep
+ * theirs.
+ */
+class FrameSnapshotStore {
+public:
+    /**
+     * Get the singleton instance of the store.
+     */
+    static FrameSnapshotStore* GetInstance();
+    
+    /**
+     * Read the plugin config and create the snapshot directory.
+     */
+    void Open();
+    
+    /**
+     * Log the final statistics.
+     */
+    void Close();
+    
+    /**
+     * Stage the stored snapshot as the frame's pending paint, unless the
+     * page has painted already.
+     * @param url page the source shows now; a snapshot of another page is
+     *        not restored
+     * @return true if a snapshot was staged
+     */
+    bool Restore(const char* uuid, const std::string& url, ChromiumSource* frame);
+    
+    /**
+     * Write the frame's last paint for the source.
+     */
+    void Save(const char* uuid, const std::string& url, ChromiumSource* frame);
+    
+    /**
+     * Delete the source's snapshot, unless OBS is tearing every source
+     * down.
+     * @return true if the snapshot is gone for good and must not be saved
+     *         again when the source is destroyed
+     */
+    bool Remove(const char* uuid);
+    
+    /**
+     * Get a snapshot of the counters.
+     */
+    SnapshotStats GetStats() const;
+    
+    /**
+     * Write the counters to the OBS log.
+     */
+    void LogStats() const;
+    
+private:
+    FrameSnapshotStore();
+    
+    std::string directory_;
+    bool enabled_;
+    
+    // Set while OBS exits or changes scene collection
+    std::atomic<bool> tearing_down_;
+    
+    std::atomic<uint64_t> saved_;
+    std::atomic<uint64_t> restored_;
+    std::atomic<uint64_t> removed_;
+    std::atomic<uint64_t> raw_bytes_;
+    std::atomic<uint64_t> stored_bytes_;
+    
+    std::string GetPath(const char* uuid) const;
+    
+    static void OnFrontendEvent(enum obs_frontend_event event, void* param);
+};
+
+/**
+ * Snapshot directory, inside the module config directory.
+ */
+#define SNAPSHOT_DIR "frame_snapshots"
+#define SNAPSHOT_EXTENSION ".frame"
+
+/**
+ * File header, followed by the page URL and the qCompress'd pixels.
+ */
+#define SNAPSHOT_MAGIC 0x504e5343u     // "CSNP"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_COMPRESSION 1         // zlib level: fastest, BGRA pages compress well anyway
+#define SNAPSHOT_MAX_PIXELS (7680u * 4320u)
@@ -0,0 +1,116 @@
+#include "fused_effect.h"
+#include <obs-module.h>
+#include <graphics/vec2.h>
+#include <graphics/vec3.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <string>
+
+FusedEffect::FusedEffect()
+    : effect_(nullptr)
+    , features_(0)
+    , failed_(false) {
+}
+
+FusedEffect::~FusedEffect() {
+    if (effect_) {
+        obs_enter_graphics();
+        gs_effect_destroy(effect_);
+        obs_leave_graphics();
+    }
+}
+
+gs_effect_t* FusedEffect::Prepare(const FusedEffectSettings& settings) {
+    uint32_t features = GetFeatures(settings);
+    if (!features) {
+        return nullptr;
+    }
+    
+    if (features != features_) {
+        if (effect_) {
+            gs_effect_destroy(effect_);
+        }
+        effect_ = Compile(features);
+        features_ = features;
+        failed_ = !effect_;
+    }
+    if (failed_) {
+        return nullptr;
+    }
+    
+    if (features & (FUSED_FEATURE_CHROMA_KEY | FUSED_FEATURE_COLOR_KEY)) {
+        float r = (float)(settings.key_color & 0xFF) / 255.0f;
+        float g = (float)((settings.key_color >> 8) & 0xFF) / 255.0f;
+        float b = (float)((settings.key_color >> 16) & 0xFF) / 255.0f;
+        
+        // Same conversion as RGBToChroma in the effect
+        struct vec2 chroma;
+        vec2_set(&chroma, -0.168736f * r - 0.331264f * g + 0.5f * b + 0.5f,
+                 0.5f * r - 0.418688f * g - 0.081312f * b + 0.5f);
+        struct vec3 rgb;
+        vec3_set(&rgb, r, g, b);
+        
+        gs_effect_set_vec2(gs_effect_get_param_by_name(effect_, "key_chroma"), &chroma);
+        gs_effect_set_vec3(gs_effect_get_param_by_name(effect_, "key_rgb"), &rgb);
+        gs_effect_set_float(gs_effect_get_param_by_name(effect_, "similarity"), settings.similarity);
+        gs_effect_set_float(gs_effect_get_param_by_name(effect_, "smoothness"), std::max(settings.smoothness, 0.001f));
+    }
+    if (features & FUSED_FEATURE_OPACITY) {
+        gs_effect_set_float(gs_effect_get_param_by_name(effect_, "opacity"), settings.opacity);
+    }
+    return effect_;
+}
+
+bool FusedEffect::IsActive(const FusedEffectSettings& settings) const {
+    uint32_t features = GetFeatures(settings);
+    return features && !(failed_ && features == features_);
+}
+
+uint32_t FusedEffect::GetFeatures(const FusedEffectSettings& settings) {
+    uint32_t features = 0;
+    if (settings.key_mode == FUSED_KEY_CHROMA) {
+        features |= FUSED_FEATURE_CHROMA_KEY;
+    } else if (settings.key_mode == FUSED_KEY_COLOR) {
+        features |= FUSED_FEATURE_COLOR_KEY;
+    }
+    if (settings.opacity < 1.0f) {
+        features |= FUSED_FEATURE_OPACITY;
+    }
+    return features;
+}
+
+gs_effect_t* FusedEffect::Compile(uint32_t features) {
+    char* path = obs_module_file(FUSED_EFFECT_FILE);
+    char* text = path ? os_quick_read_utf8_file(path) : nullptr;
+    if (!text) {
+        blog(LOG_ERROR, "[Fused Effect] Could not read %s", FUSED_EFFECT_FILE);
+        bfree(path);
+        return nullptr;
+    }
+    
+    std::string source;
+    if (features & FUSED_FEATURE_CHROMA_KEY) {
+        source += "#define FUSED_CHROMA_KEY\n";
+    }
+    if (features & FUSED_FEATURE_COLOR_KEY) {
+        source += "#define FUSED_COLOR_KEY\n";
+    }
+    if (features & FUSED_FEATURE_OPACITY) {
+        source += "#define FUSED_OPACITY\n";
+    }
+    source += text;
+    
+    char* errors = nullptr;
+    gs_effect_t* effect = gs_effect_create(source.c_str(), path, &errors);
+    if (!effect) {
+        blog(LOG_ERROR, "[Fused Effect] Failed to compile permutation 0x%x: %s",
+             features, errors ? errors : "unknown error");
+    } else {
+        blog(LOG_DEBUG, "[Fused Effect] Compiled permutation 0x%x", features);
+    }
+    
+    bfree(errors);
+    bfree(text);
+    bfree(path);
+    return effect;
+}
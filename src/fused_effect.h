@@ -0,0 +1,75 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/graphics.h>
+#include <cstdint>
+
+/**
+ * Settings of the built-in key and opacity effects.
+ */
+struct FusedEffectSettings {
+    int key_mode;          // FUSED_KEY_*
+    uint32_t key_color;    // OBS color, 0xAABBGGRR
+    float similarity;
+    float smoothness;
+    float opacity;         // 0..1
+    
+    FusedEffectSettings()
+        : key_mode(0)
+        , key_color(0)
+        , similarity(0.0f)
+        , smoothness(0.0f)
+        , opacity(1.0f) {
+    }
+};
+
+/**
+ * Color key and opacity applied while the source draws its texture,
+ * replacing a chain of OBS filters that would each render a full-size
+ * pass. The enabled features pick a permutation of data/effects/fused.effect
+ * compiled with matching defines, so disabled features cost nothing; with
+ * none enabled the source keeps its plain draw. One instance per source,
+ * used on the graphics thread only.
+ */
+class FusedEffect {
+public:
+    FusedEffect();
+    ~FusedEffect();
+    
+    /**
+     * Get the effect for the given settings with its parameters set, or
+     * nullptr if no feature is enabled or the permutation failed to
+     * compile. Recompiles when the set of enabled features changes.
+     */
+    gs_effect_t* Prepare(const FusedEffectSettings& settings);
+    
+    /**
+     * Check whether Prepare would return an effect for the given settings,
+     * i.e. the draw runs a key or opacity permutation.
+     */
+    bool IsActive(const FusedEffectSettings& settings) const;
+    
+private:
+    gs_effect_t* effect_;
+    uint32_t features_;     // FUSED_FEATURE_* bits effect_ was compiled with
+    bool failed_;           // features_ did not compile, do not retry
+    
+    static uint32_t GetFeatures(const FusedEffectSettings& settings);
+    static gs_effect_t* Compile(uint32_t features);
+};
+
+/**
+ * Key modes.
+ */
+#define FUSED_KEY_NONE 0
+#define FUSED_KEY_CHROMA 1
+#define FUSED_KEY_COLOR 2
+
+/**
+ * Permutation bits; each maps to a define in the effect file.
+ */
+#define FUSED_FEATURE_CHROMA_KEY 0x1
+#define FUSED_FEATURE_COLOR_KEY 0x2
+#define FUSED_FEATURE_OPACITY 0x4
+
+#define FUSED_EFFECT_FILE "effects/fused.effect"
@@ -0,0 +1,138 @@
+#include "idle_release.h"
+#include "upload_scheduler.h"
+#include "plugin.h"
+#include <obs-module.h>
+#include <QByteArray>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/**
+ * Box-filter a BGRA image down by THUMBNAIL_DIVISOR. CEF paints
+ * premultiplied alpha, so channels can be averaged independently.
+ */
+std::vector<uint8_t> Downscale(const std::vector<uint8_t>& bgra, int width, int height,
+                               int& out_width, int& out_height) {
+    out_width = std::max(width / THUMBNAIL_DIVISOR, 1);
+    out_height = std::max(height / THUMBNAIL_DIVISOR, 1);
+    int block_width = width / out_width;
+    int block_height = height / out_height;
+    int block = block_width * block_height;
+    
+    std::vector<uint8_t> out((size_t)out_width * out_height * 4);
+    for (int y = 0; y < out_height; y++) {
+        uint8_t* dst = out.data() + (size_t)y * out_width * 4;
+        for (int x = 0; x < out_width; x++) {
+            uint32_t sum[4] = {0, 0, 0, 0};
+            for (int by = 0; by < block_height; by++) {
+                const uint8_t* src = bgra.data() + ((size_t)(y * block_height + by) * width + (size_t)x * block_width) * 4;
+                for (int bx = 0; bx < block_width; bx++, src += 4) {
+                    sum[0] += src[0];
+                    sum[1] += src[1];
+                    sum[2] += src[2];
+                    sum[3] += src[3];
+                }
+            }
+            for (int c = 0; c < 4; c++) {
+                *dst++ = (uint8_t)(sum[c] / block);
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+IdleReleaser* IdleReleaser::GetInstance() {
+    static IdleReleaser instance;
+    return &instance;
+}
+
+IdleReleaser::IdleReleaser()
+    : grace_ns_(0)
+    , released_(0)
+    , restored_(0)
+    , released_bytes_(0)
+    , thumbnail_bytes_(0) {
+}
+
+void IdleReleaser::Open() {
+    obs_data_t* config = ChromiumPlugin::GetInstance()->GetConfig();
+    long long seconds = config ? obs_data_get_int(config, CONFIG_IDLE_RELEASE) : 0;
+    grace_ns_ = seconds > 0 ? (uint64_t)seconds * 1000000000ULL : 0;
+    
+    if (grace_ns_) {
+        blog(LOG_INFO, "[Idle Release] Frames hidden for %lld s are released", seconds);
+    } else {
+        blog(LOG_INFO, "[Idle Release] Disabled");
+    }
+}
+
+void IdleReleaser::Close() {
+    if (grace_ns_) {
+        LogStats();
+    }
+}
+
+uint64_t IdleReleaser::GetGraceNs() const {
+    return grace_ns_;
+}
+
+bool IdleReleaser::Release(ChromiumSource* frame, FrameThumbnail& thumbnail) {
+    std::vector<uint8_t> bgra;
+    int width = 0;
+    int height = 0;
+    uint64_t released = UploadScheduler::GetInstance()->ReleaseFrame(frame, bgra, width, height);
+    if (!released) {
+        return false;
+    }
+    
+    thumbnail = FrameThumbnail();
+    thumbnail.released_bytes = released;
+    if (width > 0 && height > 0 && bgra.size() == (size_t)width * (size_t)height * 4) {
+        std::vector<uint8_t> small = Downscale(bgra, width, height, thumbnail.width, thumbnail.height);
+        QByteArray compressed = qCompress(small.data(), (int)small.size(), THUMBNAIL_COMPRESSION);
+        thumbnail.data.assign(compressed.constBegin(), compressed.constEnd());
+    }
+    
+    released_++;
+    released_bytes_ += released;
+    thumbnail_bytes_ += thumbnail.data.size();
+    return true;
+}
+
+void IdleReleaser::Restore(ChromiumSource* frame, FrameThumbnail& thumbnail) {
+    FrameThumbnail taken;
+    std::swap(taken, thumbnail);
+    if (taken.data.empty()) {
+        return;
+    }
+    
+    QByteArray uncompressed = qUncompress(taken.data.data(), (int)taken.data.size());
+    if ((size_t)uncompressed.size() != (size_t)taken.width * (size_t)taken.height * 4) {
+        return;
+    }
+    
+    std::vector<uint8_t> bgra(uncompressed.constBegin(), uncompressed.constEnd());
+    if (UploadScheduler::GetInstance()->RestoreFrame(frame, bgra, taken.width, taken.height)) {
+        restored_++;
+    }
+}
+
+IdleReleaseStats IdleReleaser::GetStats() const {
+    IdleReleaseStats stats;
+    stats.released = released_;
+    stats.restored = restored_;
+    stats.released_bytes = released_bytes_;
+    stats.thumbnail_bytes = thumbnail_bytes_;
+    return stats;
+}
+
+void IdleReleaser::LogStats() const {
+    IdleReleaseStats stats = GetStats();
+    
+    blog(LOG_INFO, "[Idle Release] released: %llu (%.1f MB, kept %.1f MB of thumbnails), restored: %llu",
+         (unsigned long long)stats.released, stats.released_bytes / (1024.0 * 1024.0),
+         stats.thumbnail_bytes / (1024.0 * 1024.0), (unsigned long long)stats.restored);
+}
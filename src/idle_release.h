@@ -0,0 +1,114 @@
+#pragma once
+
+#include <obs-module.h>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+// Forward declarations
+struct ChromiumSource;
+
+/**
+ * Compressed, downscaled copy of a released frame's last paint.
+ */
+struct FrameThumbnail {
+    std::vector<uint8_t> data;   // qCompress'd BGRA
+    int width;
+    int height;
+    uint64_t released_bytes;     // frame memory given up for it
+    
+    FrameThumbnail()
+        : width(0)
+        , height(0)
+        , released_bytes(0) {
+    }
+};
+
+/**
+ * Counters describing idle releases across all sources.
+ */
+struct IdleReleaseStats {
+    uint64_t released;
+    uint64_t restored;
+    uint64_t released_bytes;
+    uint64_t thumbnail_bytes;
+    
+    IdleReleaseStats()
+        : released(0)
+        , restored(0)
+        , released_bytes(0)
+        , thumbnail_bytes(0) {
+    }
+};
+
+/**
+ * Gives back the frame memory of sources that nobody is looking at. Once a
+ * frame has been hidden for the configured grace period its texture goes
+ * back to the TexturePool and its staging and upload buffers are freed,
+ * leaving only a compressed thumbnail of the last paint. When the source
+ * is shown again the thumbnail is uploaded right away, so it is on screen
+ * from the first rendered frame until the page paints at full quality.
+ */
+class IdleReleaser {
+public:
+    /**
+     * Get the singleton instance of the releaser.
+     */
+    static IdleReleaser* GetInstance();
+    
+    /**
+     * Read the grace period from the plugin config.
+     */
+    void Open();
+    
+    /**
+     * Log the final statistics.
+     */
+    void Close();
+    
+    /**
+     * Time a frame has to stay hidden before it is released; 0 when idle
+     * release is off.
+     */
+    uint64_t GetGraceNs() const;
+    
+    /**
+     * Release the frame's texture and buffers, keeping a thumbnail of its
+     * last paint.
+     * @return false if the frame held nothing to release
+     */
+    bool Release(ChromiumSource* frame, FrameThumbnail& thumbnail);
+    
+    /**
+     * Upload the thumbnail as the frame's texture, unless the page has
+     * painted since it was released. Enters the graphics context. The
+     * thumbnail is emptied.
+     */
+    void Restore(ChromiumSource* frame, FrameThumbnail& thumbnail);
+    
+    /**
+     * Get a snapshot of the counters.
+     */
+    IdleReleaseStats GetStats() const;
+    
+    /**
+     * Write the counters to the OBS log.
+     */
+    void LogStats() const;
+    
+private:
+    IdleReleaser();
+    
+    uint64_t grace_ns_;
+    
+    std::atomic<uint64_t> released_;
+    std::atomic<uint64_t> restored_;
+    std::atomic<uint64_t> released_bytes_;
+    std::atomic<uint64_t> thumbnail_bytes_;
+};
+
+/**
+ * Thumbnail size as a fraction of the paint, per side.
+ */
+#define THUMBNAIL_DIVISOR 2
+#define THUMBNAIL_COMPRESSION 1        // zlib level
@@ -0,0 +1,402 @@
+#include "memory_watchdog.h"
+#include "plugin.h"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+MemoryWatchdog* MemoryWatchdog::GetInstance() {
+    static MemoryWatchdog instance;
+    return &instance;
+}
+
+MemoryWatchdog::MemoryWatchdog()
+    : total_rss_kb_(0)
+    , stop_(false) {
+}
+
+void MemoryWatchdog::Register(ChromiumSource* frame) {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[frame] = Entry();
+    
+    // Sampling starts with the first registered source
+    if (!thread_.joinable()) {
+        stop_ = false;
+        thread_ = std::thread(&MemoryWatchdog::Run, this);
+    }
+#else
+    UNUSED_PARAMETER(frame);
+#endif
+}
+
+void MemoryWatchdog::Unregister(ChromiumSource* frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(frame);
+}
+
+void MemoryWatchdog::ResetFrame(ChromiumSource* frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(frame);
+    if (it != entries_.end()) {
+        it->second = Entry();
+    }
+}
+
+bool MemoryWatchdog::GetUsage(ChromiumSource* frame, RendererMemory& usage) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(frame);
+    if (it == entries_.end() || !it->second.pid) {
+        return false;
+    }
+    
+    usage = it->second.usage;
+    return true;
+}
+
+bool MemoryWatchdog::IsUnattributed(ChromiumSource* frame) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(frame);
+    return it != entries_.end() && it->second.unattributed;
+}
+
+uint64_t MemoryWatchdog::GetTotalRendererRSS() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_rss_kb_;
+}
+
+void MemoryWatchdog::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void MemoryWatchdog::Run() {
+    blog(LOG_INFO, "[Memory Watchdog] Sampling renderer memory every %d ms", MEMORY_SAMPLE_INTERVAL_MS);
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        lock.unlock();
+        SampleOnce();
+        lock.lock();
+        
+        wake_.wait_for(lock, std::chrono::milliseconds(MEMORY_SAMPLE_INTERVAL_MS),
+                       [this]() { return stop_; });
+    }
+}
+
+void MemoryWatchdog::SampleOnce() {
+    // /proc is walked without holding the lock
+    std::vector<RendererProcess> renderers = ListRenderers();
+    uint64_t now_ns = os_gettime_ns();
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    total_rss_kb_ = 0;
+    for (const RendererProcess& renderer : renderers) {
+        total_rss_kb_ += renderer.rss_kb;
+    }
+    
+    auto find_renderer = [&renderers](int pid) -> const RendererProcess* {
+        for (const RendererProcess& renderer : renderers) {
+            if (renderer.pid == pid) {
+                return &renderer;
+            }
+        }
+        return nullptr;
+    };
+    
+    // Attribute renderers to frames that navigated or lost theirs
+    std::set<int> claimed;
+    for (auto& item : entries_) {
+        Entry& entry = item.second;
+        uint64_t navigation_ns = item.first->navigation_ns;
+        if (entry.pid && find_renderer(entry.pid) &&
+            entry.matched_navigation_ns == navigation_ns) {
+            claimed.insert(entry.pid);
+        }
+    }
+    
+    std::vector<ChromiumSource*> pending;
+    for (auto& item : entries_) {
+        Entry& entry = item.second;
+        if (!(entry.pid && find_renderer(entry.pid) && entry.matched_navigation_ns == item.first->navigation_ns)) {
+            pending.push_back(item.first);
+        }
+    }
+    
+    auto in_window = [](const RendererProcess& renderer, uint64_t navigation_ns) {
+        return navigation_ns && renderer.start_ns + 1000000000ULL >= navigation_ns &&
+               renderer.start_ns <= navigation_ns + MEMORY_MATCH_WINDOW_NS;
+    };
+    
+    for (ChromiumSource* frame : pending) {
+        Entry& entry = entries_[frame];
+        uint64_t navigation_ns = frame->navigation_ns;
+        
+        // Only trust a match nothing else could claim: exactly one unclaimed
+        // renderer spawned after this navigation, and no other navigating
+        // frame whose window holds it. A renderer reused for the page, as
+        // process-per-site does, never matches and stays unknown.
+        const RendererProcess* match = nullptr;
+        int candidates = 0;
+        for (const RendererProcess& renderer : renderers) {
+            if (!claimed.count(renderer.pid) && in_window(renderer, navigation_ns)) {
+                match = &renderer;
+                candidates++;
+            }
+        }
+        bool unique = candidates == 1;
+        for (ChromiumSource* other : pending) {
+            if (unique && other != frame && in_window(*match, other->navigation_ns)) {
+                unique = false;
+            }
+        }
+        
+        if (unique) {
+            if (entry.pid != match->pid) {
+                entry.pid = match->pid;
+                entry.history.clear();
+                entry.cpu_sampled_ns = 0;
+            }
+            claimed.insert(match->pid);
+        } else {
+            entry.pid = 0;
+            entry.usage = RendererMemory();
+            entry.history.clear();
+            entry.cpu_sampled_ns = 0;
+        }
+        entry.unattributed = navigation_ns && !unique;
+        entry.matched_navigation_ns = navigation_ns;
+    }
+    
+    // Count how many frames each renderer serves
+    std::map<int, int> users;
+    for (auto& item : entries_) {
+        if (item.second.pid) {
+            users[item.second.pid]++;
+        }
+    }
+    
+    for (auto& item : entries_) {
+        Entry& entry = item.second;
+        const RendererProcess* renderer = entry.pid ? find_renderer(entry.pid) : nullptr;
+        if (!renderer) {
+            continue;
+        }
+        
+        entry.usage.pid = renderer->pid;
+        entry.usage.rss_kb = renderer->rss_kb;
+        entry.usage.pss_kb = renderer->pss_kb;
+        entry.usage.shared = users[renderer->pid] > 1;
+        
+        entry.history.push_back({now_ns, renderer->pss_kb});
+        while (entry.history.size() > MEMORY_HISTORY_SAMPLES) {
+            entry.history.pop_front();
+        }
+        
+        const Sample& first = entry.history.front();
+        const Sample& last = entry.history.back();
+        if (last.time_ns > first.time_ns) {
+            double hours = (last.time_ns - first.time_ns) / 3600000000000.0;
+            entry.usage.trend_mb_per_hour = ((double)last.pss_kb - (double)first.pss_kb) / 1024.0 / hours;
+        }
+        
+        if (entry.cpu_sampled_ns && now_ns > entry.cpu_sampled_ns && renderer->cpu_s >= entry.cpu_s) {
+            double wall_s = (now_ns - entry.cpu_sampled_ns) / 1000000000.0;
+            entry.usage.cpu_percent = 100.0 * (renderer->cpu_s - entry.cpu_s) / wall_s;
+        }
+        entry.cpu_s = renderer->cpu_s;
+        entry.cpu_sampled_ns = now_ns;
+        
+        if (now_ns - entry.last_log_ns >= MEMORY_LOG_INTERVAL_NS) {
+            entry.last_log_ns = now_ns;
+            blog(LOG_INFO, "[Memory Watchdog] '%s' renderer %d: PSS %.1f MB, RSS %.1f MB, trend %+.1f MB/h, CPU %.1f%%%s",
+                 item.first->source ? obs_source_get_name(item.first->source) : "(pooled)",
+                 renderer->pid, renderer->pss_kb / 1024.0, renderer->rss_kb / 1024.0,
+                 entry.usage.trend_mb_per_hour, entry.usage.cpu_percent, entry.usage.shared ? " (shared)" : "");
+        }
+    }
+}
+
+#ifdef __linux__
+// Parse "Key:   1234 kB" lines from a /proc file
+static bool ReadProcValue(const char* path, const char* key, uint64_t& value_kb) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    
+    size_t key_len = strlen(key);
+    char line[256];
+    bool found = false;
+    
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == ':') {
+            value_kb = strtoull(line + key_len + 1, nullptr, 10);
+            found = true;
+            break;
+        }
+    }
+    
+    fclose(file);
+    return found;
+}
+
+// Read the parent pid, CPU time and start time (clock ticks) from /proc/<pid>/stat
+static bool ReadProcStat(int pid, int& ppid, uint64_t& start_ticks, uint64_t* cpu_ticks = nullptr) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    
+    char buffer[1024];
+    size_t len = fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    buffer[len] = '\0';
+    
+    // The command name may contain spaces, so fields are counted after ')'
+    char* p = strrchr(buffer, ')');
+    if (!p) {
+        return false;
+    }
+    
+    int field = 2;
+    char* save = nullptr;
+    for (char* token = strtok_r(p + 1, " ", &save); token; token = strtok_r(nullptr, " ", &save)) {
+        field++;
+        if (field == 4) {
+            ppid = atoi(token);
+        } else if ((field == 14 || field == 15) && cpu_ticks) {
+            *cpu_ticks += strtoull(token, nullptr, 10);
+        } else if (field == 22) {
+            start_ticks = strtoull(token, nullptr, 10);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool IsRendererOf(int pid, int browser_pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
+    
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    
+    char buffer[4096];
+    size_t len = fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    
+    // Arguments are NUL separated
+    buffer[len] = '\0';
+    bool renderer = false;
+    for (size_t i = 0; i < len; i += strlen(buffer + i) + 1) {
+        if (strcmp(buffer + i, "--type=renderer") == 0) {
+            renderer = true;
+            break;
+        }
+    }
+    if (!renderer) {
+        return false;
+    }
+    
+    // Renderers are forked from the zygote, so walk up a few parents
+    int current = pid;
+    for (int depth = 0; depth < 4; ++depth) {
+        int ppid = 0;
+        uint64_t ticks = 0;
+        if (!ReadProcStat(current, ppid, ticks) || ppid <= 1) {
+            return false;
+        }
+        if (ppid == browser_pid) {
+            return true;
+        }
+        current = ppid;
+    }
+    return false;
+}
+#endif
+
+std::vector<MemoryWatchdog::RendererProcess> MemoryWatchdog::ListRenderers() {
+    std::vector<RendererProcess> renderers;
+
+#ifdef __linux__
+    DIR* proc = opendir("/proc");
+    if (!proc) {
+        return renderers;
+    }
+    
+    // Process start times are relative to boot; convert to os_gettime_ns
+    double uptime_s = 0.0;
+    FILE* uptime = fopen("/proc/uptime", "r");
+    if (uptime) {
+        if (fscanf(uptime, "%lf", &uptime_s) != 1) {
+            uptime_s = 0.0;
+        }
+        fclose(uptime);
+    }
+    uint64_t now_ns = os_gettime_ns();
+    long ticks_per_s = sysconf(_SC_CLK_TCK);
+    int self = getpid();
+    
+    struct dirent* entry;
+    while ((entry = readdir(proc)) != nullptr) {
+        int pid = atoi(entry->d_name);
+        if (pid <= 0 || !IsRendererOf(pid, self)) {
+            continue;
+        }
+        
+        int ppid = 0;
+        uint64_t start_ticks = 0;
+        uint64_t cpu_ticks = 0;
+        if (!ReadProcStat(pid, ppid, start_ticks, &cpu_ticks)) {
+            continue;
+        }
+        
+        RendererProcess renderer = {};
+        renderer.pid = pid;
+        renderer.cpu_s = (double)cpu_ticks / (double)ticks_per_s;
+        
+        double age_s = uptime_s - (double)start_ticks / (double)ticks_per_s;
+        uint64_t age_ns = age_s > 0.0 ? (uint64_t)(age_s * 1000000000.0) : 0;
+        renderer.start_ns = now_ns > age_ns ? now_ns - age_ns : 0;
+        
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%d/status", pid);
+        ReadProcValue(path, "VmRSS", renderer.rss_kb);
+        
+        // smaps_rollup is cheap (kernel 4.14+); fall back to RSS without it
+        snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+        if (!ReadProcValue(path, "Pss", renderer.pss_kb)) {
+            renderer.pss_kb = renderer.rss_kb;
+        }
+        
+        renderers.push_back(renderer);
+    }
+    
+    closedir(proc);
+#endif
+
+    return renderers;
+}
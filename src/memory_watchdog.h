@@ -0,0 +1,140 @@
+#pragma once
+
+#include <obs-module.h>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// Forward declarations
+struct ChromiumSource;
+
+/**
+ * Memory figures for the renderer process behind one source.
+ */
+struct RendererMemory {
+    int pid;
+    uint64_t rss_kb;
+    uint64_t pss_kb;
+    double trend_mb_per_hour;   // PSS growth over the sample window
+    double cpu_percent;         // of one core, since the previous sample
+    bool shared;                // renderer also serves other sources
+    
+    RendererMemory()
+        : pid(0)
+        , rss_kb(0)
+        , pss_kb(0)
+        , trend_mb_per_hour(0.0)
+        , cpu_percent(0.0)
+        , shared(false) {
+    }
+};
+
+/**
+ * Samples the RSS/PSS of each source's renderer process from /proc and
+ * keeps a short history to report the growth trend. CPU time is sampled
+ * alongside so the cost of a page can be compared across settings. CEF does not expose
+ * renderer PIDs, so a renderer is attributed to a source by matching its
+ * start time against the source's last main-frame navigation. Only a
+ * match no other navigating source could claim is trusted; otherwise the
+ * source's renderer is reported as unknown.
+ * Only implemented on Linux; elsewhere all queries report nothing.
+ */
+class MemoryWatchdog {
+public:
+    /**
+     * Get the singleton instance of the watchdog.
+     */
+    static MemoryWatchdog* GetInstance();
+    
+    /**
+     * Start sampling the renderer behind a source's frame.
+     */
+    void Register(ChromiumSource* frame);
+    
+    /**
+     * Stop sampling a frame. Must be called before the frame is destroyed.
+     */
+    void Unregister(ChromiumSource* frame);
+    
+    /**
+     * Forget the renderer attributed to a frame, e.g. after a browser swap.
+     */
+    void ResetFrame(ChromiumSource* frame);
+    
+    /**
+     * Get the latest sample for a frame.
+     * @return false if no renderer has been attributed yet
+     */
+    bool GetUsage(ChromiumSource* frame, RendererMemory& usage) const;
+    
+    /**
+     * Check whether the frame navigated but its renderer could not be told
+     * apart from another source's, or was reused from an earlier page.
+     */
+    bool IsUnattributed(ChromiumSource* frame) const;
+    
+    /**
+     * Sum of RSS over all renderer processes belonging to this OBS process.
+     */
+    uint64_t GetTotalRendererRSS() const;
+    
+    /**
+     * Stop the sampling thread.
+     */
+    void Shutdown();
+    
+private:
+    MemoryWatchdog();
+    
+    struct Sample {
+        uint64_t time_ns;
+        uint64_t pss_kb;
+    };
+    
+    struct Entry {
+        int pid;
+        uint64_t matched_navigation_ns;
+        RendererMemory usage;
+        std::deque<Sample> history;
+        uint64_t last_log_ns;
+        double cpu_s;            // renderer CPU time at the previous sample
+        uint64_t cpu_sampled_ns;
+        bool unattributed;       // navigated, but no unambiguous renderer
+        
+        Entry() : pid(0), matched_navigation_ns(0), last_log_ns(0), cpu_s(0.0), cpu_sampled_ns(0),
+                  unattributed(false) {
+        }
+    };
+    
+    struct RendererProcess {
+        int pid;
+        uint64_t start_ns;   // on the os_gettime_ns clock
+        uint64_t rss_kb;
+        uint64_t pss_kb;
+        double cpu_s;        // user + system time
+    };
+    
+    mutable std::mutex mutex_;
+    std::map<ChromiumSource*, Entry> entries_;
+    uint64_t total_rss_kb_;
+    
+    std::thread thread_;
+    std::condition_variable wake_;
+    bool stop_;
+    
+    void Run();
+    void SampleOnce();
+    static std::vector<RendererProcess> ListRenderers();
+};
+
+/**
+ * Sampling parameters.
+ */
+#define MEMORY_SAMPLE_INTERVAL_MS 10000
+#define MEMORY_HISTORY_SAMPLES 60                  // 10 minutes of history
+#define MEMORY_LOG_INTERVAL_NS 300000000000ULL     // 5 minutes
+#define MEMORY_MATCH_WINDOW_NS 30000000000ULL      // renderer start after navigation
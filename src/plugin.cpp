@@ -2,6 +2,16 @@
 #include "cef_browser.h"
 #include "cef_audio.h"
 #include "chromium_source.h"
+#include "region_view_source.h"
+#include "browser_pool.h"
+#include "memory_watchdog.h"
+#include "upload_scheduler.h"
+#include "asset_cache.h"
+#include "asset_prefetch.h"
+#include "request_blocker.h"
+#include "texture_pool.h"
+#include "frame_snapshot.h"
+#include "idle_release.h"
 #include <obs-module.h>
 #include <obs-frontend-api.h>
 #include <util/platform.h>
@@ -42,6 +52,10 @@ bool obs_module_load(void) {
     chromium_source_info.video_render = chromium_source_video_render;
     chromium_source_info.get_width = chromium_source_get_width;
     chromium_source_info.get_height = chromium_source_get_height;
+    chromium_source_info.activate = chromium_source_activate;
+    chromium_source_info.deactivate = chromium_source_deactivate;
+    chromium_source_info.show = chromium_source_show;
+    chromium_source_info.hide = chromium_source_hide;
     chromium_source_info.get_properties = chromium_source_get_properties;
     chromium_source_info.get_defaults = chromium_source_get_defaults;
     chromium_source_info.enum_active_sources = chromium_source_enum_active_sources;
@@ -49,6 +63,39 @@ bool obs_module_load(void) {
     
     obs_register_source(&chromium_source_info);
     
+    // Same source feeding OBS's async frame queue instead of drawing itself
+    struct obs_source_info chromium_async_source_info = chromium_source_info;
+    chromium_async_source_info.id = CHROMIUM_ASYNC_SOURCE_ID;
+    chromium_async_source_info.output_flags = OBS_SOURCE_ASYNC_VIDEO | OBS_SOURCE_AUDIO | OBS_SOURCE_DO_NOT_DUPLICATE;
+    chromium_async_source_info.get_name = [](void*) -> const char* { return CHROMIUM_ASYNC_SOURCE_NAME; };
+    chromium_async_source_info.video_render = nullptr;
+    chromium_async_source_info.get_width = nullptr;
+    chromium_async_source_info.get_height = nullptr;
+    chromium_async_source_info.get_properties = chromium_async_source_get_properties;
+    
+    obs_register_source(&chromium_async_source_info);
+    
+    // Register the region view source type
+    struct obs_source_info region_view_source_info = {};
+    region_view_source_info.id = REGION_VIEW_SOURCE_ID;
+    region_view_source_info.type = OBS_SOURCE_TYPE_INPUT;
+    region_view_source_info.output_flags = OBS_SOURCE_VIDEO;
+    region_view_source_info.get_name = [](void*) -> const char* { return REGION_VIEW_SOURCE_NAME; };
+    region_view_source_info.create = region_view_source_create;
+    region_view_source_info.destroy = region_view_source_destroy;
+    region_view_source_info.update = region_view_source_update;
+    region_view_source_info.video_tick = region_view_source_video_tick;
+    region_view_source_info.video_render = region_view_source_video_render;
+    region_view_source_info.get_width = region_view_source_get_width;
+    region_view_source_info.get_height = region_view_source_get_height;
+    region_view_source_info.get_properties = region_view_source_get_properties;
+    region_view_source_info.get_defaults = region_view_source_get_defaults;
+    region_view_source_info.enum_active_sources = region_view_source_enum_sources;
+    region_view_source_info.enum_all_sources = region_view_source_enum_sources;
+    region_view_source_info.icon_type = OBS_ICON_TYPE_BROWSER;
+    
+    obs_register_source(&region_view_source_info);
+    
     blog(LOG_INFO, "[Chromium Plugin] Plugin loaded successfully");
     return true;
 }
@@ -75,13 +122,15 @@ const char* obs_module_name(void) {
 }
 
 // ChromiumPlugin implementation
-ChromiumPlugin::ChromiumPlugin() : initialized_(false) {
+ChromiumPlugin::ChromiumPlugin() : initialized_(false), config_(nullptr) {
 }
 
 ChromiumPlugin::~ChromiumPlugin() {
     if (initialized_) {
         Shutdown();
     }
+    
+    obs_data_release(config_);
 }
 
 ChromiumPlugin* ChromiumPlugin::GetInstance() {
@@ -96,17 +145,25 @@ bool ChromiumPlugin::Initialize() {
         return true;
     }
     
-    blog(LOG_INFO, "[Chromium Plugin] Initializing CEF framework");
+    LoadConfig();
     
-    try {
-        InitializeCEF();
-        initialized_ = true;
-        blog(LOG_INFO, "[Chromium Plugin] CEF framework initialized successfully");
-        return true;
-    } catch (const std::exception& e) {
-        blog(LOG_ERROR, "[Chromium Plugin] Failed to initialize CEF: %s", e.what());
-        return false;
-    }
+    // Paints are uploaded once per OBS frame within a shared budget
+    UploadScheduler::GetInstance()->Start();
+    
+    // Index only; stored alert media is mapped when first requested
+    AssetCache::GetInstance()->Open();
+    AssetPrefetcher::GetInstance()->Open();
+    RequestBlocker::GetInstance()->Open();
+    
+    // Sources created from here on start from their last frame
+    FrameSnapshotStore::GetInstance()->Open();
+    IdleReleaser::GetInstance()->Open();
+    
+    // CEF is brought up lazily by the first source that needs it, so scene
+    // collections without Chromium sources never pay for it.
+    initialized_ = true;
+    blog(LOG_INFO, "[Chromium Plugin] CEF framework will start on first source use");
+    return true;
 }
 
 void ChromiumPlugin::Shutdown() {
@@ -114,6 +171,10 @@ void ChromiumPlugin::Shutdown() {
         return;
     }
     
+    UploadScheduler::GetInstance()->Stop();
+    TexturePool::GetInstance()->Clear();
+    TexturePool::GetInstance()->LogStats();
+    
     blog(LOG_INFO, "[Chromium Plugin] Shutting down CEF framework");
     
     try {
@@ -125,14 +186,73 @@ void ChromiumPlugin::Shutdown() {
     }
 }
 
+bool ChromiumPlugin::EnsureCEFStarted() {
+    if (CEFManager::IsInitialized()) {
+        return true;
+    }
+    
+    try {
+        InitializeCEF();
+        return true;
+    } catch (const std::exception& e) {
+        blog(LOG_ERROR, "[Chromium Plugin] Failed to initialize CEF: %s", e.what());
+        return false;
+    }
+}
+
+obs_data_t* ChromiumPlugin::GetConfig() const {
+    return config_;
+}
+
+void ChromiumPlugin::LoadConfig() {
+    if (config_) {
+        return;
+    }
+    
+    char* path = obs_module_config_path(CONFIG_FILE);
+    config_ = path ? obs_data_create_from_json_file_safe(path, "bak") : nullptr;
+    if (!config_) {
+        config_ = obs_data_create();
+    }
+    
+    obs_data_set_default_int(config_, CONFIG_POOL_SIZE, DEFAULT_POOL_SIZE);
+    obs_data_set_default_bool(config_, CONFIG_PROCESS_PER_SITE, DEFAULT_PROCESS_PER_SITE);
+    obs_data_set_default_int(config_, CONFIG_RENDERER_PROCESS_LIMIT, DEFAULT_RENDERER_PROCESS_LIMIT);
+    obs_data_set_default_int(config_, CONFIG_UPLOAD_BUDGET, DEFAULT_UPLOAD_BUDGET_MB);
+    obs_data_set_default_int(config_, CONFIG_ASSET_CACHE_SIZE, DEFAULT_ASSET_CACHE_MB);
+    obs_data_set_default_bool(config_, CONFIG_ASSET_CACHE_PINNED, DEFAULT_ASSET_CACHE_PINNED);
+    obs_data_set_default_int(config_, CONFIG_PREFETCH_RATE, DEFAULT_PREFETCH_RATE_KB);
+    obs_data_set_default_bool(config_, CONFIG_REQUEST_BLOCKING, DEFAULT_REQUEST_BLOCKING);
+    obs_data_set_default_bool(config_, CONFIG_FRAME_SNAPSHOTS, DEFAULT_FRAME_SNAPSHOTS);
+    obs_data_set_default_int(config_, CONFIG_IDLE_RELEASE, DEFAULT_IDLE_RELEASE_SECONDS);
+    
+    blog(LOG_INFO, "[Chromium Plugin] Loaded configuration from %s", path ? path : "(defaults)");
+    bfree(path);
+}
+
 void ChromiumPlugin::InitializeCEF() {
-    if (!CEFManager::Initialize()) {
+    if (!CEFManager::InitializeAsync()) {
         throw std::runtime_error("Failed to initialize CEF framework");
     }
 }
 
 void ChromiumPlugin::ShutdownCEF() {
+    // Pooled browsers must be closed while CEF is still running
+    BrowserPool::GetInstance()->LogStats();
+    BrowserPool::GetInstance()->Clear();
+    
+    blog(LOG_INFO, "[Chromium Plugin] Renderer processes at shutdown: %.1f MB total RSS",
+         MemoryWatchdog::GetInstance()->GetTotalRendererRSS() / 1024.0);
+    MemoryWatchdog::GetInstance()->Shutdown();
+    
     CEFManager::Shutdown();
+    
+    // No request can reach the cache any more
+    AssetPrefetcher::GetInstance()->Close();
+    AssetCache::GetInstance()->Close();
+    RequestBlocker::GetInstance()->Close();
+    FrameSnapshotStore::GetInstance()->Close();
+    IdleReleaser::GetInstance()->Close();
 }
 
 // ChromiumSource implementation
@@ -144,6 +264,25 @@ ChromiumSource::ChromiumSource()
     , volume(DEFAULT_VOLUME)
     , muted(false)
     , texture(nullptr)
+    , staging_width(0)
+    , staging_height(0)
+    , staging_dirty(false)
+    , coalesced_paints(0)
+    , upload_width(0)
+    , upload_height(0)
+    , deferred_uploads(0)
+    , visibility(0)
+    , async_output(false)
+    , program_refs(0)
+    , showing_refs(0)
+    , page_loaded(false)
+    , painted_since_load(false)
+    , renderer_crashed(false)
+    , navigation_ns(0)
+    , requests(0)
+    , prefetch_mode(0)
+    , blocked_requests(0)
+    , blocked_cost_us(0)
     , audio_source(nullptr) {
     
     url = DEFAULT_URL;
@@ -152,13 +291,18 @@ ChromiumSource::ChromiumSource()
     if (pthread_mutex_init(&texture_mutex, nullptr) != 0) {
         blog(LOG_ERROR, "[Chromium Source] Failed to initialize texture mutex");
     }
+    
+    UploadScheduler::GetInstance()->Register(this);
 }
 
 ChromiumSource::~ChromiumSource() {
-    // Cleanup texture
+    // Waits for an upload pass that may be using this frame
+    UploadScheduler::GetInstance()->Unregister(this);
+    
+    // Hand the texture back for the next frame of the same size
     if (texture) {
         obs_enter_graphics();
-        gs_texture_destroy(texture);
+        TexturePool::GetInstance()->Release(texture);
         obs_leave_graphics();
         texture = nullptr;
     }
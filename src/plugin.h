@@ -5,8 +5,13 @@
 #include <util/platform.h>
 #include <util/threading.h>
 #include <graphics/graphics.h>
+#include "browser_health.h"
+#include "alert_bridge.h"
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
+#include <atomic>
 
 // Forward declarations
 class CEFBrowser;
@@ -23,11 +28,18 @@ public:
     ~ChromiumPlugin();
     
     /**
-     * Initialize the plugin and CEF framework.
+     * Initialize the plugin. CEF itself is started on demand.
      * @return true if initialization was successful
      */
     bool Initialize();
     
+    /**
+     * Start CEF in the background if it is not already running.
+     * Sources call this on creation and wait for readiness themselves.
+     * @return false if CEF could not be started
+     */
+    bool EnsureCEFStarted();
+    
     /**
      * Shutdown the plugin and cleanup CEF resources.
      */
@@ -38,9 +50,19 @@ public:
      */
     static ChromiumPlugin* GetInstance();
     
+    /**
+     * Get the plugin-wide configuration loaded from the module config
+     * directory. Missing keys fall back to the CONFIG_* defaults below.
+     */
+    obs_data_t* GetConfig() const;
+    
 private:
     static ChromiumPlugin* instance_;
     bool initialized_;
+    obs_data_t* config_;
+    
+    // Plugin-wide configuration
+    void LoadConfig();
     
     // CEF application and message loop management
     void InitializeCEF();
@@ -70,6 +92,46 @@ struct ChromiumSource {
     gs_texture_t* texture;
     pthread_mutex_t texture_mutex;
     
+    // Latest paint waiting for the UploadScheduler
+    std::mutex staging_mutex;
+    std::vector<uint8_t> staging;
+    int staging_width;
+    int staging_height;
+    bool staging_dirty;
+    uint64_t coalesced_paints;
+    
+    // Owned by the UploadScheduler pass; the size is that of the last upload
+    std::vector<uint8_t> upload_buffer;
+    int upload_width;
+    int upload_height;
+    uint64_t deferred_uploads;
+    std::atomic<int> visibility;            // UPLOAD_VISIBLE_* bits since the last pass
+    
+    // Paints bypass the upload scheduler and go to obs_source_output_video
+    std::atomic<bool> async_output;
+    
+    // Sources sharing this frame that are on program / shown anywhere
+    std::atomic<int> program_refs;
+    std::atomic<int> showing_refs;
+    
+    // Page state, written from CEF threads
+    std::atomic<bool> page_loaded;          // main frame finished loading
+    std::atomic<bool> painted_since_load;   // a frame arrived after the load finished
+    std::atomic<bool> renderer_crashed;     // renderer died, not yet handled
+    std::atomic<uint64_t> navigation_ns;    // last main-frame load start
+    std::atomic<int> requests;              // SOURCE_REQUEST_* from any source sharing the frame
+    BrowserHealth health;
+    AlertBridge alerts;
+    
+    // Media to prefetch after each load, set by the owning source
+    std::mutex prefetch_mutex;
+    int prefetch_mode;                      // PREFETCH_MODE_*
+    std::vector<std::string> prefetch_manifest;
+    
+    // Requests cancelled by the RequestBlocker, written from the CEF IO thread
+    std::atomic<uint64_t> blocked_requests;
+    std::atomic<uint64_t> blocked_cost_us;  // estimated renderer CPU saved
+    
     // Audio
     obs_source_t* audio_source;
     
@@ -90,8 +152,15 @@ extern "C" {
     static uint32_t chromium_source_get_width(void* data);
     static uint32_t chromium_source_get_height(void* data);
     
+    // Visibility
+    static void chromium_source_activate(void* data);
+    static void chromium_source_deactivate(void* data);
+    static void chromium_source_show(void* data);
+    static void chromium_source_hide(void* data);
+    
     // Properties
     static obs_properties_t* chromium_source_get_properties(void* data);
+    static obs_properties_t* chromium_async_source_get_properties(void* data);
     static void chromium_source_get_defaults(obs_data_t* settings);
     
     // Audio
@@ -104,8 +173,35 @@ extern "C" {
 #define PLUGIN_AUTHOR "OBS Chromium Plugin"
 #define PLUGIN_DESCRIPTION "Advanced browser source with continuous rendering using Chromium Embedded Framework"
 
-// Source type ID
+// Source type IDs
 #define CHROMIUM_SOURCE_ID "chromium_browser_source"
+#define CHROMIUM_ASYNC_SOURCE_ID "chromium_browser_source_async"
+#define CHROMIUM_ASYNC_SOURCE_NAME "Chromium Browser Source (Async)"
+
+// Plugin-wide configuration file and keys
+#define CONFIG_FILE "config.json"
+#define CONFIG_POOL_SIZE "browser_pool_size"
+#define CONFIG_PROCESS_PER_SITE "process_per_site"
+#define CONFIG_RENDERER_PROCESS_LIMIT "renderer_process_limit"
+#define CONFIG_UPLOAD_BUDGET "upload_budget_mb_per_frame"
+#define CONFIG_ASSET_CACHE_SIZE "asset_cache_mb"
+#define CONFIG_ASSET_CACHE_PINNED "asset_cache_pinned"
+#define CONFIG_PREFETCH_RATE "prefetch_rate_kb"
+#define CONFIG_REQUEST_BLOCKING "block_trackers"
+#define CONFIG_FRAME_SNAPSHOTS "frame_snapshots"
+#define CONFIG_IDLE_RELEASE "idle_release_seconds"
+
+// Plugin-wide configuration defaults
+#define DEFAULT_POOL_SIZE 2
+#define DEFAULT_PROCESS_PER_SITE true
+#define DEFAULT_RENDERER_PROCESS_LIMIT 0  // Chromium's own limit
+#define DEFAULT_UPLOAD_BUDGET_MB 24       // about three 1080p frames
+#define DEFAULT_ASSET_CACHE_MB 256        // 0 disables the asset cache
+#define DEFAULT_ASSET_CACHE_PINNED false
+#define DEFAULT_PREFETCH_RATE_KB 256      // KB/s, 0 removes the limit
+#define DEFAULT_REQUEST_BLOCKING true
+#define DEFAULT_FRAME_SNAPSHOTS true
+#define DEFAULT_IDLE_RELEASE_SECONDS 60   // 0 keeps hidden frames resident
 
 // Default settings
 #define DEFAULT_WIDTH 1920
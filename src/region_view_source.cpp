@@ -0,0 +1,231 @@
+#include "region_view_source.h"
+#include "chromium_source.h"
+#include "plugin.h"
+#include <obs-module.h>
+#include <algorithm>
+#include <cstring>
+
+// OBS source callbacks implementation
+void* region_view_source_create(obs_data_t* settings, obs_source_t* source) {
+    RegionViewSource* impl = new RegionViewSource(source);
+    impl->Update(settings);
+    return impl;
+}
+
+void region_view_source_destroy(void* data) {
+    if (!data) return;
+    
+    RegionViewSource* impl = static_cast<RegionViewSource*>(data);
+    delete impl;
+}
+
+void region_view_source_update(void* data, obs_data_t* settings) {
+    if (!data) return;
+    
+    RegionViewSource* impl = static_cast<RegionViewSource*>(data);
+    impl->Update(settings);
+}
+
+void region_view_source_video_tick(void* data, float seconds) {
+    if (!data) return;
+    
+    RegionViewSource* impl = static_cast<RegionViewSource*>(data);
+    impl->VideoTick(seconds);
+}
+
+void region_view_source_video_render(void* data, gs_effect_t* effect) {
+    if (!data) return;
+    
+    RegionViewSource* impl = static_cast<RegionViewSource*>(data);
+    impl->VideoRender(effect);
+}
+
+uint32_t region_view_source_get_width(void* data) {
+    if (!data) return 0;
+    
+    RegionViewSource* impl = static_cast<RegionViewSource*>(data);
+    return impl->GetWidth();
+}
+
+uint32_t region_view_source_get_height(void* data) {
+    if (!data) return 0;
+    
+    RegionViewSource* impl = static_cast<RegionViewSource*>(data);
+    return impl->GetHeight();
+}
+
+// Collect the names of all Chromium sources for the parent list
+static bool add_chromium_source(void* param, obs_source_t* source) {
+    obs_property_t* list = static_cast<obs_property_t*>(param);
+    
+    const char* id = obs_source_get_unversioned_id(source);
+    if (id && strcmp(id, CHROMIUM_SOURCE_ID) == 0) {
+        const char* name = obs_source_get_name(source);
+        obs_property_list_add_string(list, name, name);
+    }
+    return true;
+}
+
+obs_properties_t* region_view_source_get_properties(void* data) {
+    UNUSED_PARAMETER(data);
+    
+    obs_properties_t* props = obs_properties_create();
+    
+    // Parent source dropdown
+    obs_property_t* parent_prop = obs_properties_add_list(props, PROP_REGION_PARENT, TEXT_REGION_PARENT, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+    obs_property_set_long_description(parent_prop, TEXT_REGION_PARENT_TOOLTIP);
+    obs_enum_sources(add_chromium_source, parent_prop);
+    
+    // Region rectangle
+    obs_property_t* x_prop = obs_properties_add_int(props, PROP_REGION_X, TEXT_REGION_X, 0, MAX_WIDTH, 1);
+    obs_property_set_long_description(x_prop, TEXT_REGION_POSITION_TOOLTIP);
+    
+    obs_property_t* y_prop = obs_properties_add_int(props, PROP_REGION_Y, TEXT_REGION_Y, 0, MAX_HEIGHT, 1);
+    obs_property_set_long_description(y_prop, TEXT_REGION_POSITION_TOOLTIP);
+    
+    obs_property_t* width_prop = obs_properties_add_int(props, PROP_REGION_WIDTH, TEXT_REGION_WIDTH, 1, MAX_WIDTH, 1);
+    obs_property_set_long_description(width_prop, TEXT_REGION_SIZE_TOOLTIP);
+    
+    obs_property_t* height_prop = obs_properties_add_int(props, PROP_REGION_HEIGHT, TEXT_REGION_HEIGHT, 1, MAX_HEIGHT, 1);
+    obs_property_set_long_description(height_prop, TEXT_REGION_SIZE_TOOLTIP);
+    
+    return props;
+}
+
+void region_view_source_get_defaults(obs_data_t* settings) {
+    obs_data_set_default_int(settings, PROP_REGION_X, 0);
+    obs_data_set_default_int(settings, PROP_REGION_Y, 0);
+    obs_data_set_default_int(settings, PROP_REGION_WIDTH, DEFAULT_REGION_WIDTH);
+    obs_data_set_default_int(settings, PROP_REGION_HEIGHT, DEFAULT_REGION_HEIGHT);
+}
+
+void region_view_source_enum_sources(void* data, obs_source_enum_proc_t enum_callback, void* param) {
+    if (!data) return;
+    
+    RegionViewSource* impl = static_cast<RegionViewSource*>(data);
+    impl->EnumSources(enum_callback, param);
+}
+
+// RegionViewSource implementation
+RegionViewSource::RegionViewSource(obs_source_t* source)
+    : obs_source_(source)
+    , parent_(nullptr)
+    , x_(0)
+    , y_(0)
+    , width_(DEFAULT_REGION_WIDTH)
+    , height_(DEFAULT_REGION_HEIGHT)
+    , resolve_elapsed_(0.0f) {
+}
+
+RegionViewSource::~RegionViewSource() {
+    SetParent(std::string());
+}
+
+void RegionViewSource::Update(obs_data_t* settings) {
+    x_ = std::clamp((int)obs_data_get_int(settings, PROP_REGION_X), 0, MAX_WIDTH);
+    y_ = std::clamp((int)obs_data_get_int(settings, PROP_REGION_Y), 0, MAX_HEIGHT);
+    width_ = std::clamp((int)obs_data_get_int(settings, PROP_REGION_WIDTH), 1, MAX_WIDTH);
+    height_ = std::clamp((int)obs_data_get_int(settings, PROP_REGION_HEIGHT), 1, MAX_HEIGHT);
+    
+    const char* parent = obs_data_get_string(settings, PROP_REGION_PARENT);
+    SetParent(parent ? parent : "");
+}
+
+void RegionViewSource::VideoTick(float seconds) {
+    resolve_elapsed_ += seconds;
+    if (resolve_elapsed_ < REGION_RESOLVE_INTERVAL) {
+        return;
+    }
+    resolve_elapsed_ = 0.0f;
+    
+    // The parent may be created after us while a scene collection loads,
+    // or be removed and added again under the same name
+    std::string name;
+    {
+        std::lock_guard<std::mutex> lock(parent_mutex_);
+        if (parent_name_.empty() || (parent_ && !obs_weak_source_expired(parent_))) {
+            return;
+        }
+        name = parent_name_;
+    }
+    SetParent(name);
+}
+
+void RegionViewSource::VideoRender(gs_effect_t* effect) {
+    obs_source_t* parent = GetParent();
+    if (!parent) {
+        return;
+    }
+    
+    // The parent may have been replaced by another source type under the same name
+    const char* id = obs_source_get_unversioned_id(parent);
+    if (id && strcmp(id, CHROMIUM_SOURCE_ID) == 0) {
+        ChromiumSourceImpl* impl = static_cast<ChromiumSourceImpl*>(obs_obj_get_data(parent));
+        if (impl) {
+            impl->RenderRegion(effect, x_, y_, width_, height_);
+        }
+    }
+    
+    obs_source_release(parent);
+}
+
+uint32_t RegionViewSource::GetWidth() const {
+    return width_;
+}
+
+uint32_t RegionViewSource::GetHeight() const {
+    return height_;
+}
+
+void RegionViewSource::EnumSources(obs_source_enum_proc_t enum_callback, void* param) {
+    obs_source_t* parent = GetParent();
+    if (parent) {
+        enum_callback(obs_source_, parent, param);
+        obs_source_release(parent);
+    }
+}
+
+void RegionViewSource::SetParent(const std::string& name) {
+    obs_weak_source_t* old_parent = nullptr;
+    obs_source_t* new_parent = nullptr;
+    bool retry = false;
+    
+    {
+        std::lock_guard<std::mutex> lock(parent_mutex_);
+        retry = name == parent_name_;
+        if (retry && (name.empty() || (parent_ && !obs_weak_source_expired(parent_)))) {
+            return;
+        }
+        
+        new_parent = name.empty() ? nullptr : obs_get_source_by_name(name.c_str());
+        old_parent = parent_;
+        parent_ = new_parent ? obs_source_get_weak_source(new_parent) : nullptr;
+        parent_name_ = name;
+    }
+    
+    // Move our active/showing references over to the new parent
+    if (old_parent) {
+        obs_source_t* source = obs_weak_source_get_source(old_parent);
+        if (source) {
+            obs_source_remove_active_child(obs_source_, source);
+            obs_source_release(source);
+        }
+        obs_weak_source_release(old_parent);
+    }
+    
+    if (new_parent) {
+        if (!obs_source_add_active_child(obs_source_, new_parent)) {
+            blog(LOG_WARNING, "[Region View] '%s' cannot show '%s': it would create a loop",
+                 obs_source_get_name(obs_source_), name.c_str());
+        }
+        obs_source_release(new_parent);
+    } else if (!name.empty() && !retry) {
+        blog(LOG_WARNING, "[Region View] '%s' parent source '%s' not found",
+             obs_source_get_name(obs_source_), name.c_str());
+    }
+}
+
+obs_source_t* RegionViewSource::GetParent() {
+    std::lock_guard<std::mutex> lock(parent_mutex_);
+    return parent_ ? obs_weak_source_get_source(parent_) : nullptr;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <obs-module.h>
+#include <obs-properties.h>
+#include <graphics/graphics.h>
+#include <mutex>
+#include <string>
+
+/**
+ * Lightweight source that shows a sub-rectangle of another Chromium
+ * source's texture. It has no browser of its own, so one page laid out
+ * with alerts, goal bar and chat can feed several independently placed
+ * scene items. The parent is reported as an active child, which keeps it
+ * painting while only its regions are on screen.
+ */
+class RegionViewSource {
+public:
+    explicit RegionViewSource(obs_source_t* source);
+    ~RegionViewSource();
+    
+    /**
+     * Update source settings.
+     */
+    void Update(obs_data_t* settings);
+    
+    /**
+     * Video tick callback, resolves a parent that is not loaded yet.
+     */
+    void VideoTick(float seconds);
+    
+    /**
+     * Draw the region of the parent's current frame.
+     */
+    void VideoRender(gs_effect_t* effect);
+    
+    /**
+     * Get the region width.
+     */
+    uint32_t GetWidth() const;
+    
+    /**
+     * Get the region height.
+     */
+    uint32_t GetHeight() const;
+    
+    /**
+     * Enumerate the parent source as an active child.
+     */
+    void EnumSources(obs_source_enum_proc_t enum_callback, void* param);
+    
+private:
+    obs_source_t* obs_source_;
+    
+    // Parent Chromium source, looked up by name
+    std::mutex parent_mutex_;
+    std::string parent_name_;
+    obs_weak_source_t* parent_;
+    
+    // Region in parent pixels
+    int x_;
+    int y_;
+    int width_;
+    int height_;
+    
+    // Time since the last attempt to find a missing parent
+    float resolve_elapsed_;
+    
+    void SetParent(const std::string& name);
+    obs_source_t* GetParent();
+};
+
+// OBS source callbacks
+extern "C" {
+    void* region_view_source_create(obs_data_t* settings, obs_source_t* source);
+    void region_view_source_destroy(void* data);
+    void region_view_source_update(void* data, obs_data_t* settings);
+    void region_view_source_video_tick(void* data, float seconds);
+    void region_view_source_video_render(void* data, gs_effect_t* effect);
+    uint32_t region_view_source_get_width(void* data);
+    uint32_t region_view_source_get_height(void* data);
+    obs_properties_t* region_view_source_get_properties(void* data);
+    void region_view_source_get_defaults(obs_data_t* settings);
+    void region_view_source_enum_sources(void* data, obs_source_enum_proc_t enum_callback, void* param);
+}
+
+// Source type ID
+#define REGION_VIEW_SOURCE_ID "chromium_region_view_source"
+#define REGION_VIEW_SOURCE_NAME "Chromium Region View"
+
+/**
+ * Property identifiers for settings.
+ */
+#define PROP_REGION_PARENT "parent_source"
+#define PROP_REGION_X "region_x"
+#define PROP_REGION_Y "region_y"
+#define PROP_REGION_WIDTH "region_width"
+#define PROP_REGION_HEIGHT "region_height"
+
+/**
+ * Default property values.
+ */
+#define DEFAULT_REGION_WIDTH 400
+#define DEFAULT_REGION_HEIGHT 300
+
+/**
+ * Seconds between lookups of a parent source that does not exist yet.
+ */
+#define REGION_RESOLVE_INTERVAL 1.0f
+
+/**
+ * Localization text keys.
+ */
+#define TEXT_REGION_PARENT "Chromium Source"
+#define TEXT_REGION_PARENT_TOOLTIP "The Chromium source whose page this view crops from"
+#define TEXT_REGION_X "X"
+#define TEXT_REGION_Y "Y"
+#define TEXT_REGION_WIDTH "Width"
+#define TEXT_REGION_HEIGHT "Height"
+#define TEXT_REGION_POSITION_TOOLTIP "Offset of the region from the top-left of the page, in page pixels"
+#define TEXT_REGION_SIZE_TOOLTIP "Size of the region, in page pixels"
@@ -0,0 +1,335 @@
+#include "request_blocker.h"
+#include "plugin.h"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+/**
+ * Cancels every request it is asked about.
+ */
+class BlockedRequestHandler : public CefResourceRequestHandler {
+public:
+    ReturnValue OnBeforeResourceLoad(CefRefPtr<CefBrowser> browser,
+                                     CefRefPtr<CefFrame> frame,
+                                     CefRefPtr<CefRequest> request,
+                                     CefRefPtr<CefCallback> callback) override {
+        return RV_CANCEL;
+    }
+    
+    IMPLEMENT_REFCOUNTING(BlockedRequestHandler);
+};
+
+std::string_view Trim(std::string_view text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end + 1 - begin);
+}
+
+bool StartsWith(std::string_view text, std::string_view prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+RequestBlocker* RequestBlocker::GetInstance() {
+    static RequestBlocker instance;
+    return &instance;
+}
+
+RequestBlocker::RequestBlocker()
+    : blocking_handler_(new BlockedRequestHandler())
+    , enabled_(false)
+    , rules_(0)
+    , checked_(0)
+    , blocked_(0)
+    , match_ns_(0) {
+    host_nodes_.push_back({{}, false, -1});
+    path_nodes_.push_back({{}, false});
+}
+
+void RequestBlocker::Open() {
+    obs_data_t* config = ChromiumPlugin::GetInstance()->GetConfig();
+    if (!config || !obs_data_get_bool(config, CONFIG_REQUEST_BLOCKING)) {
+        blog(LOG_INFO, "[Request Blocker] Disabled");
+        return;
+    }
+    
+    char* path = obs_module_config_path(BLOCKER_RULES_FILE);
+    if (!path || !os_file_exists(path)) {
+        bfree(path);
+        path = obs_module_file(BLOCKER_RULES_FILE);
+    }
+    char* text = path ? os_quick_read_utf8_file(path) : nullptr;
+    if (!text) {
+        blog(LOG_WARNING, "[Request Blocker] No %s found, nothing is blocked", BLOCKER_RULES_FILE);
+        bfree(path);
+        return;
+    }
+    
+    std::string_view rules(text);
+    while (!rules.empty()) {
+        size_t end = rules.find('\n');
+        AddRule(rules.substr(0, end));
+        rules = end == std::string_view::npos ? std::string_view() : rules.substr(end + 1);
+    }
+    enabled_ = rules_ > 0;
+    
+    blog(LOG_INFO, "[Request Blocker] %zu rules from %s (%zu host nodes, %zu path nodes)",
+         rules_, path, host_nodes_.size(), path_nodes_.size());
+    bfree(text);
+    bfree(path);
+}
+
+void RequestBlocker::Close() {
+    if (enabled_) {
+        LogStats();
+    }
+}
+
+bool RequestBlocker::Check(CefRefPtr<CefRequest> request, uint32_t& cost_us) {
+    if (!enabled_) {
+        return false;
+    }
+    
+    std::string url = request->GetURL().ToString();
+    uint64_t start_ns = os_gettime_ns();
+    bool blocked = Match(url);
+    match_ns_ += os_gettime_ns() - start_ns;
+    checked_++;
+    
+    if (!blocked) {
+        return false;
+    }
+    blocked_++;
+    cost_us = EstimateCost(request->GetResourceType());
+    return true;
+}
+
+CefRefPtr<CefResourceRequestHandler> RequestBlocker::GetBlockingHandler() const {
+    return blocking_handler_;
+}
+
+BlockerStats RequestBlocker::GetStats() const {
+    BlockerStats stats;
+    stats.checked = checked_;
+    stats.blocked = blocked_;
+    stats.match_ns = match_ns_;
+    stats.rules = rules_;
+    return stats;
+}
+
+void RequestBlocker::LogStats() const {
+    BlockerStats stats = GetStats();
+    
+    blog(LOG_INFO, "[Request Blocker] checked: %llu, blocked: %llu, average match: %.0f ns",
+         (unsigned long long)stats.checked, (unsigned long long)stats.blocked,
+         stats.checked ? (double)stats.match_ns / (double)stats.checked : 0.0);
+}
+
+bool RequestBlocker::Match(std::string_view url) const {
+    size_t scheme_end = url.find("://");
+    if (scheme_end == std::string_view::npos) {
+        return false;
+    }
+    
+    // Chromium hands over canonical URLs: the host is already lower case
+    size_t host_start = scheme_end + 3;
+    size_t host_end = url.find_first_of(":/?#", host_start);
+    std::string_view host = url.substr(host_start, host_end == std::string_view::npos ? std::string_view::npos : host_end - host_start);
+    size_t path_start = url.find('/', host_start);
+    std::string_view path = path_start == std::string_view::npos ? std::string_view("/") : url.substr(path_start);
+    path = path.substr(0, path.find('#'));
+    
+    // Labels from the top-level domain down
+    uint32_t node = 0;
+    size_t end = host.size();
+    while (end > 0) {
+        size_t dot = host.rfind('.', end - 1);
+        size_t begin = dot == std::string_view::npos ? 0 : dot + 1;
+        std::string_view label = host.substr(begin, end - begin);
+        
+        const auto& children = host_nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), label,
+                                   [](const std::pair<std::string, uint32_t>& child, std::string_view key) {
+                                       return std::string_view(child.first) < key;
+                                   });
+        if (it == children.end() || it->first != label) {
+            break;
+        }
+        node = it->second;
+        
+        const HostNode& host_node = host_nodes_[node];
+        if (host_node.block_all || (host_node.paths >= 0 && MatchPath((uint32_t)host_node.paths, path))) {
+            return true;
+        }
+        if (dot == std::string_view::npos) {
+            break;
+        }
+        end = dot;
+    }
+    
+    return MatchPath(0, path);
+}
+
+bool RequestBlocker::MatchPath(uint32_t root, std::string_view path) const {
+    uint32_t node = root;
+    for (char c : path) {
+        const auto& children = path_nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), c,
+                                   [](const std::pair<char, uint32_t>& child, char key) {
+                                       return child.first < key;
+                                   });
+        if (it == children.end() || it->first != c) {
+            return false;
+        }
+        node = it->second;
+        if (path_nodes_[node].terminal) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RequestBlocker::AddRule(std::string_view rule) {
+    rule = Trim(rule.substr(0, rule.find(" #")));
+    if (rule.empty() || rule[0] == '#' || rule[0] == '!' || StartsWith(rule, "@@")) {
+        return;
+    }
+    
+    // Adblock options ($third-party, $script, ...) are not supported; the
+    // rule applies to every request
+    rule = Trim(rule.substr(0, rule.find('$')));
+    
+    // Hosts file: the address goes, the name stays
+    size_t space = rule.find_last_of(" \t");
+    if (space != std::string_view::npos) {
+        rule = rule.substr(space + 1);
+    }
+    
+    if (StartsWith(rule, "||")) {
+        rule.remove_prefix(2);
+    }
+    if (StartsWith(rule, "http://")) {
+        rule.remove_prefix(7);
+    } else if (StartsWith(rule, "https://")) {
+        rule.remove_prefix(8);
+    }
+    if (StartsWith(rule, "*.")) {
+        rule.remove_prefix(2);
+    }
+    while (!rule.empty() && (rule.back() == '^' || rule.back() == '*')) {
+        rule.remove_suffix(1);
+    }
+    if (rule.empty()) {
+        return;
+    }
+    
+    if (rule[0] == '/') {
+        if (rule.size() == 1) {
+            return;     // would block everything
+        }
+        AddPath(0, rule);
+        rules_++;
+        return;
+    }
+    
+    size_t slash = rule.find('/');
+    std::string host(rule.substr(0, slash));
+    std::transform(host.begin(), host.end(), host.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    while (!host.empty() && host.back() == '^') {
+        host.pop_back();
+    }
+    if (host.empty() || host == "localhost" || host.find_first_of("*^|") != std::string::npos) {
+        return;
+    }
+    
+    uint32_t node = 0;
+    size_t end = host.size();
+    while (end > 0) {
+        size_t dot = host.rfind('.', end - 1);
+        size_t begin = dot == std::string::npos ? 0 : dot + 1;
+        std::string label = host.substr(begin, end - begin);
+        
+        auto& children = host_nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), label,
+                                   [](const std::pair<std::string, uint32_t>& child, const std::string& key) {
+                                       return child.first < key;
+                                   });
+        if (it != children.end() && it->first == label) {
+            node = it->second;
+        } else {
+            uint32_t child = (uint32_t)host_nodes_.size();
+            children.insert(it, std::make_pair(label, child));
+            host_nodes_.push_back({{}, false, -1});
+            node = child;
+        }
+        
+        if (dot == std::string::npos) {
+            break;
+        }
+        end = dot;
+    }
+    
+    if (slash == std::string_view::npos) {
+        host_nodes_[node].block_all = true;
+    } else {
+        if (host_nodes_[node].paths < 0) {
+            host_nodes_[node].paths = (int32_t)NewPathNode();
+        }
+        AddPath((uint32_t)host_nodes_[node].paths, rule.substr(slash));
+    }
+    rules_++;
+}
+
+void RequestBlocker::AddPath(uint32_t root, std::string_view path) {
+    uint32_t node = root;
+    for (char c : path) {
+        auto& children = path_nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), c,
+                                   [](const std::pair<char, uint32_t>& child, char key) {
+                                       return child.first < key;
+                                   });
+        if (it != children.end() && it->first == c) {
+            node = it->second;
+        } else {
+            // Adding the node moves the vector holding children
+            size_t index = (size_t)(it - children.begin());
+            uint32_t child = NewPathNode();
+            auto& moved = path_nodes_[node].children;
+            moved.insert(moved.begin() + index, std::make_pair(c, child));
+            node = child;
+        }
+    }
+    path_nodes_[node].terminal = true;
+}
+
+uint32_t RequestBlocker::NewPathNode() {
+    path_nodes_.push_back({{}, false});
+    return (uint32_t)path_nodes_.size() - 1;
+}
+
+uint32_t RequestBlocker::EstimateCost(CefRequest::ResourceType type) {
+    switch (type) {
+        case RT_SCRIPT:
+        case RT_WORKER:
+        case RT_SHARED_WORKER:
+        case RT_SERVICE_WORKER:
+            return BLOCK_COST_SCRIPT_US;
+        case RT_SUB_FRAME:
+            return BLOCK_COST_FRAME_US;
+        case RT_XHR:
+        case RT_PING:
+        case RT_CSP_REPORT:
+        case RT_IMAGE:
+            return BLOCK_COST_BEACON_US;
+        default:
+            return BLOCK_COST_OTHER_US;
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <include/cef_request.h>
+#include <include/cef_resource_request_handler.h>
+#include <obs-module.h>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Counters describing the blocker's work across all sources.
+ */
+struct BlockerStats {
+    uint64_t checked;
+    uint64_t blocked;
+    uint64_t match_ns;         // total time spent matching
+    size_t rules;
+    
+    BlockerStats()
+        : checked(0)
+        , blocked(0)
+        , match_ns(0)
+        , rules(0) {
+    }
+};
+
+/**
+ * Cancels requests from overlay pages to trackers, ads and telemetry before
+ * they reach the network. Rules are compiled once at startup into two
+ * tries: one over host labels from the top-level domain down, where a node
+ * either blocks the host and its subdomains or carries a path-prefix trie
+ * for it, and one over path prefixes that apply to every host. A check
+ * walks each trie once without allocating. The tries are never modified
+ * after Open, so checks take no lock.
+ *
+ * Rule file syntax, one rule per line:
+ *   example.com            host and subdomains
+ *   ||example.com^         the same, as written in adblock lists
+ *   0.0.0.0 example.com    the same, as written in hosts files
+ *   example.com/ads/       paths starting with /ads/ on the host
+ *   /gtag/js               the path prefix on any host
+ *   # or !                 comment
+ * Adblock options ($...) are ignored and exception rules (@@) skipped.
+ */
+class RequestBlocker {
+public:
+    /**
+     * Get the singleton instance of the blocker.
+     */
+    static RequestBlocker* GetInstance();
+    
+    /**
+     * Compile the rule file. The user's file in the module config
+     * directory replaces the list shipped with the plugin.
+     */
+    void Open();
+    
+    /**
+     * Log the final statistics.
+     */
+    void Close();
+    
+    /**
+     * Check a request against the rules. Called on the CEF IO thread.
+     * @param cost_us receives the estimated renderer CPU time the request
+     *        would have cost, in microseconds
+     * @return true if the request must be cancelled
+     */
+    bool Check(CefRefPtr<CefRequest> request, uint32_t& cost_us);
+    
+    /**
+     * Handler that cancels the request it is given.
+     */
+    CefRefPtr<CefResourceRequestHandler> GetBlockingHandler() const;
+    
+    /**
+     * Get a snapshot of the counters.
+     */
+    BlockerStats GetStats() const;
+    
+    /**
+     * Write the counters to the OBS log.
+     */
+    void LogStats() const;
+    
+private:
+    RequestBlocker();
+    
+    struct HostNode {
+        std::vector<std::pair<std::string, uint32_t>> children;   // sorted by label
+        bool block_all;
+        int32_t paths;          // root in path_nodes_, or -1
+    };
+    
+    struct PathNode {
+        std::vector<std::pair<char, uint32_t>> children;          // sorted by character
+        bool terminal;
+    };
+    
+    std::vector<HostNode> host_nodes_;   // [0] is the root
+    std::vector<PathNode> path_nodes_;   // [0] is the root of the any-host trie
+    CefRefPtr<CefResourceRequestHandler> blocking_handler_;
+    bool enabled_;
+    size_t rules_;
+    
+    std::atomic<uint64_t> checked_;
+    std::atomic<uint64_t> blocked_;
+    std::atomic<uint64_t> match_ns_;
+    
+    bool Match(std::string_view url) const;
+    bool MatchPath(uint32_t root, std::string_view path) const;
+    void AddRule(std::string_view rule);
+    void AddPath(uint32_t root, std::string_view path);
+    uint32_t NewPathNode();
+    
+    static uint32_t EstimateCost(CefRequest::ResourceType type);
+};
+
+/**
+ * Rule file, looked up in the module config directory and then in the
+ * module data directory.
+ */
+#define BLOCKER_RULES_FILE "blocklist.txt"
+
+/**
+ * Rough renderer CPU cost of a request that is never made, by resource
+ * type: a tracker script is fetched, parsed, compiled and run, a frame
+ * brings a document of its own, beacons and pixels are cheap.
+ */
+#define BLOCK_COST_SCRIPT_US 20000
+#define BLOCK_COST_FRAME_US 50000
+#define BLOCK_COST_BEACON_US 500
+#define BLOCK_COST_OTHER_US 1000
@@ -0,0 +1,30 @@
+#include "request_context_policy.h"
+#include "plugin.h"
+#include <include/cef_command_line.h>
+#include <obs-module.h>
+
+RequestContextPolicy* RequestContextPolicy::GetInstance() {
+    static RequestContextPolicy instance;
+    return &instance;
+}
+
+RequestContextPolicy::RequestContextPolicy() {
+}
+
+void RequestContextPolicy::ApplyCommandLine(CefRefPtr<CefCommandLine> command_line) {
+    obs_data_t* config = ChromiumPlugin::GetInstance()->GetConfig();
+    if (!config) {
+        return;
+    }
+    
+    int limit = (int)obs_data_get_int(config, CONFIG_RENDERER_PROCESS_LIMIT);
+    if (limit > 0) {
+        command_line->AppendSwitchWithValue("--renderer-process-limit", std::to_string(limit));
+        blog(LOG_INFO, "[Request Context] Renderer process limit: %d", limit);
+    }
+    
+    if (obs_data_get_bool(config, CONFIG_PROCESS_PER_SITE)) {
+        command_line->AppendSwitch("--process-per-site");
+        blog(LOG_INFO, "[Request Context] Using process-per-site");
+    }
+}
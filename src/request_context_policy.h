@@ -0,0 +1,26 @@
+#pragma once
+
+#include <include/cef_command_line.h>
+#include <obs-module.h>
+
+/**
+ * Supplies the renderer process model switches applied at CEF startup.
+ * All browsers stay in the global request context, so pooled browsers fit
+ * any source; with process-per-site, overlays from the same provider
+ * still share one renderer process.
+ */
+class RequestContextPolicy {
+public:
+    /**
+     * Get the singleton instance of the policy.
+     */
+    static RequestContextPolicy* GetInstance();
+    
+    /**
+     * Append the renderer process model switches from the plugin config.
+     */
+    void ApplyCommandLine(CefRefPtr<CefCommandLine> command_line);
+    
+private:
+    RequestContextPolicy();
+};
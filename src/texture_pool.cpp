@@ -0,0 +1,235 @@
+#include "texture_pool.h"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <cstring>
+
+TexturePool* TexturePool::GetInstance() {
+    static TexturePool instance;
+    return &instance;
+}
+
+TexturePool::TexturePool()
+    : trimmed_ns_(0) {
+}
+
+gs_texture_t* TexturePool::Acquire(uint32_t width, uint32_t height) {
+    uint64_t bytes = GetBytes(width, height);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = idle_.find(GetKey(width, height));
+        if (it == idle_.end()) {
+            // No exact match; the smallest larger texture that is not too
+            // wasteful will do
+            for (auto candidate = idle_.begin(); candidate != idle_.end(); ++candidate) {
+                uint32_t idle_width = (uint32_t)(candidate->first >> 32);
+                uint32_t idle_height = (uint32_t)candidate->first;
+                uint64_t idle_bytes = GetBytes(idle_width, idle_height);
+                if (idle_width >= width && idle_height >= height &&
+                    idle_bytes <= bytes * TEXTURE_POOL_MAX_SLACK &&
+                    (it == idle_.end() || idle_bytes < GetBytes((uint32_t)(it->first >> 32), (uint32_t)it->first))) {
+                    it = candidate;
+                }
+            }
+        }
+        if (it != idle_.end() && !it->second.empty()) {
+            bytes = GetBytes((uint32_t)(it->first >> 32), (uint32_t)it->first);
+            gs_texture_t* texture = it->second.back().texture;
+            it->second.pop_back();
+            if (it->second.empty()) {
+                idle_.erase(it);
+            }
+            stats_.idle_bytes -= bytes;
+            stats_.idle_textures--;
+            stats_.live_bytes += bytes;
+            stats_.reused++;
+            return texture;
+        }
+    }
+    
+    gs_texture_t* texture = gs_texture_create(width, height, GS_BGRA, 1, nullptr, GS_DYNAMIC);
+    if (!texture) {
+        return nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.live_bytes += bytes;
+    stats_.created++;
+    return texture;
+}
+
+void TexturePool::Release(gs_texture_t* texture) {
+    if (!texture) {
+        return;
+    }
+    
+    uint32_t width = gs_texture_get_width(texture);
+    uint32_t height = gs_texture_get_height(texture);
+    uint64_t bytes = GetBytes(width, height);
+    
+    std::vector<gs_texture_t*> doomed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_[GetKey(width, height)].push_back({texture, os_gettime_ns()});
+        stats_.live_bytes -= bytes;
+        stats_.idle_bytes += bytes;
+        stats_.idle_textures++;
+        
+        while (stats_.idle_bytes > TEXTURE_POOL_MAX_IDLE_BYTES) {
+            TakeOldestLocked(doomed);
+        }
+    }
+    
+    // Already inside the graphics context
+    for (gs_texture_t* old : doomed) {
+        gs_texture_destroy(old);
+    }
+}
+
+void TexturePool::Trim(uint64_t now_ns) {
+    std::vector<gs_texture_t*> doomed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (now_ns - trimmed_ns_ < TEXTURE_POOL_TRIM_INTERVAL_NS) {
+            return;
+        }
+        trimmed_ns_ = now_ns;
+        
+        for (auto it = idle_.begin(); it != idle_.end();) {
+            std::vector<Idle>& bucket = it->second;
+            uint64_t bytes = 0;
+            auto keep = bucket.begin();
+            for (const Idle& idle : bucket) {
+                if (now_ns - idle.released_ns >= TEXTURE_POOL_IDLE_NS) {
+                    doomed.push_back(idle.texture);
+                    bytes += GetBytes((uint32_t)(it->first >> 32), (uint32_t)it->first);
+                } else {
+                    *keep++ = idle;
+                }
+            }
+            stats_.idle_bytes -= bytes;
+            stats_.idle_textures -= bucket.end() - keep;
+            stats_.expired += bucket.end() - keep;
+            bucket.erase(keep, bucket.end());
+            it = bucket.empty() ? idle_.erase(it) : std::next(it);
+        }
+    }
+    
+    if (doomed.empty()) {
+        return;
+    }
+    
+    obs_enter_graphics();
+    for (gs_texture_t* texture : doomed) {
+        gs_texture_destroy(texture);
+    }
+    obs_leave_graphics();
+}
+
+void TexturePool::Clear() {
+    std::vector<gs_texture_t*> doomed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& pair : idle_) {
+            for (const Idle& idle : pair.second) {
+                doomed.push_back(idle.texture);
+            }
+        }
+        idle_.clear();
+        stats_.expired += doomed.size();
+        stats_.idle_bytes = 0;
+        stats_.idle_textures = 0;
+    }
+    
+    if (doomed.empty()) {
+        return;
+    }
+    
+    obs_enter_graphics();
+    for (gs_texture_t* texture : doomed) {
+        gs_texture_destroy(texture);
+    }
+    obs_leave_graphics();
+}
+
+TexturePoolStats TexturePool::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void TexturePool::LogStats() const {
+    TexturePoolStats stats = GetStats();
+    
+    blog(LOG_INFO, "[Texture Pool] created: %llu, reused: %llu, expired: %llu, held: %.1f MB (%.1f MB idle in %zu textures)",
+         (unsigned long long)stats.created, (unsigned long long)stats.reused,
+         (unsigned long long)stats.expired, (stats.live_bytes + stats.idle_bytes) / (1024.0 * 1024.0),
+         stats.idle_bytes / (1024.0 * 1024.0), stats.idle_textures);
+}
+
+bool TexturePool::Fits(gs_texture_t* texture, uint32_t width, uint32_t height) {
+    if (!texture) {
+        return false;
+    }
+    uint32_t tex_width = gs_texture_get_width(texture);
+    uint32_t tex_height = gs_texture_get_height(texture);
+    return tex_width >= width && tex_height >= height &&
+           GetBytes(tex_width, tex_height) <= GetBytes(width, height) * TEXTURE_POOL_MAX_SLACK;
+}
+
+void TexturePool::Upload(gs_texture_t* texture, const uint8_t* bgra, uint32_t width, uint32_t height) {
+    uint32_t tex_width = gs_texture_get_width(texture);
+    uint32_t tex_height = gs_texture_get_height(texture);
+    if (tex_width == width && tex_height == height) {
+        gs_texture_set_image(texture, bgra, width * 4, false);
+        return;
+    }
+    
+    uint8_t* ptr;
+    uint32_t linesize;
+    if (!width || !height || !gs_texture_map(texture, &ptr, &linesize)) {
+        return;
+    }
+    
+    size_t row = (size_t)width * 4;
+    bool pad_x = tex_width > width;
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t* out = ptr + (size_t)y * linesize;
+        memcpy(out, bgra + y * row, row);
+        if (pad_x) {
+            memcpy(out + row, out + row - 4, 4);
+        }
+    }
+    if (tex_height > height) {
+        memcpy(ptr + (size_t)height * linesize, ptr + (size_t)(height - 1) * linesize, row + (pad_x ? 4 : 0));
+    }
+    
+    gs_texture_unmap(texture);
+}
+
+void TexturePool::TakeOldestLocked(std::vector<gs_texture_t*>& doomed) {
+    auto oldest = idle_.end();
+    for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+        if (oldest == idle_.end() || it->second.front().released_ns < oldest->second.front().released_ns) {
+            oldest = it;
+        }
+    }
+    if (oldest == idle_.end()) {
+        return;
+    }
+    
+    doomed.push_back(oldest->second.front().texture);
+    oldest->second.erase(oldest->second.begin());
+    stats_.idle_bytes -= GetBytes((uint32_t)(oldest->first >> 32), (uint32_t)oldest->first);
+    stats_.idle_textures--;
+    stats_.expired++;
+    if (oldest->second.empty()) {
+        idle_.erase(oldest);
+    }
+}
+
+uint64_t TexturePool::GetKey(uint32_t width, uint32_t height) {
+    return ((uint64_t)width << 32) | height;
+}
+
+uint64_t TexturePool::GetBytes(uint32_t width, uint32_t height) {
+    return (uint64_t)width * height * 4;   // BGRA
+}
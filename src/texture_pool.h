@@ -0,0 +1,121 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/graphics.h>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Counters describing the pool's textures.
+ */
+struct TexturePoolStats {
+    uint64_t reused;           // acquisitions served from the pool
+    uint64_t created;
+    uint64_t expired;          // idle textures destroyed
+    uint64_t live_bytes;       // in use by frames
+    uint64_t idle_bytes;       // waiting in the pool
+    size_t idle_textures;
+    
+    TexturePoolStats()
+        : reused(0)
+        , created(0)
+        , expired(0)
+        , live_bytes(0)
+        , idle_bytes(0)
+        , idle_textures(0) {
+    }
+};
+
+/**
+ * Plugin-wide pool of the dynamic BGRA textures frames upload into,
+ * bucketed by size. A frame whose paint size changes keeps its texture if
+ * the paint still fits, and otherwise hands it back and takes one that
+ * fits from the pool: the exact size when a resize, an auto resolution
+ * step or another source has used it recently, else the smallest larger
+ * idle texture within TEXTURE_POOL_MAX_SLACK. A paint smaller than its
+ * texture fills the top-left corner and is drawn as a subregion, so
+ * textures are only created when nothing idle is large enough. Idle textures are destroyed after TEXTURE_POOL_IDLE_NS, or
+ * oldest first once they hold more than TEXTURE_POOL_MAX_IDLE_BYTES.
+ */
+class TexturePool {
+public:
+    /**
+     * Get the singleton instance of the pool.
+     */
+    static TexturePool* GetInstance();
+    
+    /**
+     * Get a texture that fits the given size, creating one only if no idle
+     * texture does. Must be called inside the graphics context.
+     */
+    gs_texture_t* Acquire(uint32_t width, uint32_t height);
+    
+    /**
+     * Hand a texture back for reuse. Must be called inside the graphics
+     * context.
+     */
+    void Release(gs_texture_t* texture);
+    
+    /**
+     * Destroy textures that have been idle too long. Enters the graphics
+     * context only when there is something to destroy.
+     */
+    void Trim(uint64_t now_ns);
+    
+    /**
+     * Destroy all idle textures.
+     */
+    void Clear();
+    
+    /**
+     * Get a snapshot of the counters.
+     */
+    TexturePoolStats GetStats() const;
+    
+    /**
+     * Write the counters to the OBS log.
+     */
+    void LogStats() const;
+    
+    /**
+     * Check whether a paint of the given size can be uploaded into a
+     * texture without wasting more than TEXTURE_POOL_MAX_SLACK.
+     */
+    static bool Fits(gs_texture_t* texture, uint32_t width, uint32_t height);
+    
+    /**
+     * Write a BGRA paint into the top-left corner of a texture. The last
+     * column and row are repeated into the spare texels, so bilinear
+     * sampling at the paint's edge does not pick up stale pixels. Must be
+     * called inside the graphics context.
+     */
+    static void Upload(gs_texture_t* texture, const uint8_t* bgra, uint32_t width, uint32_t height);
+    
+private:
+    TexturePool();
+    
+    struct Idle {
+        gs_texture_t* texture;
+        uint64_t released_ns;
+    };
+    
+    mutable std::mutex mutex_;
+    std::map<uint64_t, std::vector<Idle>> idle_;   // by size key, newest last
+    TexturePoolStats stats_;
+    uint64_t trimmed_ns_;
+    
+    void TakeOldestLocked(std::vector<gs_texture_t*>& doomed);
+    
+    static uint64_t GetKey(uint32_t width, uint32_t height);
+    static uint64_t GetBytes(uint32_t width, uint32_t height);
+};
+
+/**
+ * Pool limits.
+ */
+#define TEXTURE_POOL_IDLE_NS 10000000000ULL         // 10 seconds
+#define TEXTURE_POOL_MAX_IDLE_BYTES (128ULL * 1024 * 1024)
+#define TEXTURE_POOL_TRIM_INTERVAL_NS 1000000000ULL // 1 second
+#define TEXTURE_POOL_MAX_SLACK 2                    // texture bytes per paint byte
@@ -0,0 +1,330 @@
+#include "upload_scheduler.h"
+#include "plugin.h"
+#include "texture_pool.h"
+#include <obs-module.h>
+#include <graphics/graphics.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Shows up in the OBS profiler next to OBS's own async frame uploads
+static const char* upload_pass_name = "chromium_upload_pass";
+
+UploadScheduler* UploadScheduler::GetInstance() {
+    static UploadScheduler instance;
+    return &instance;
+}
+
+UploadScheduler::UploadScheduler()
+    : started_(false)
+    , budget_bytes_((uint64_t)DEFAULT_UPLOAD_BUDGET_MB * 1024 * 1024)
+    , last_log_ns_(0) {
+}
+
+void UploadScheduler::Start() {
+    obs_data_t* config = ChromiumPlugin::GetInstance()->GetConfig();
+    int budget_mb = config ? (int)obs_data_get_int(config, CONFIG_UPLOAD_BUDGET) : DEFAULT_UPLOAD_BUDGET_MB;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (started_) {
+            return;
+        }
+        started_ = true;
+        last_log_ns_ = os_gettime_ns();
+        budget_bytes_ = (uint64_t)std::max(budget_mb, 1) * 1024 * 1024;
+    }
+    
+    obs_add_tick_callback(Tick, this);
+    blog(LOG_INFO, "[Upload Scheduler] Upload budget %d MB per frame", std::max(budget_mb, 1));
+}
+
+void UploadScheduler::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_) {
+            return;
+        }
+        started_ = false;
+    }
+    
+    obs_remove_tick_callback(Tick, this);
+    LogStats();
+}
+
+void UploadScheduler::Register(ChromiumSource* frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames_.insert(frame);
+}
+
+void UploadScheduler::Unregister(ChromiumSource* frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames_.erase(frame);
+}
+
+void UploadScheduler::StagePaint(ChromiumSource* frame, const void* buffer, int width, int height) {
+    size_t size = (size_t)width * (size_t)height * 4; // BGRA
+    
+    std::lock_guard<std::mutex> lock(frame->staging_mutex);
+    if (frame->staging_dirty) {
+        frame->coalesced_paints++;
+    }
+    
+    frame->staging.resize(size);
+    memcpy(frame->staging.data(), buffer, size);
+    frame->staging_width = width;
+    frame->staging_height = height;
+    frame->staging_dirty = true;
+}
+
+bool UploadScheduler::CopyLastFrame(ChromiumSource* frame, std::vector<uint8_t>& bgra, int& width, int& height) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> staging_lock(frame->staging_mutex);
+    
+    if (frame->staging_dirty) {
+        bgra = frame->staging;
+        width = frame->staging_width;
+        height = frame->staging_height;
+    } else {
+        bgra = frame->upload_buffer;
+        width = frame->upload_width;
+        height = frame->upload_height;
+    }
+    return width > 0 && height > 0 && bgra.size() == (size_t)width * (size_t)height * 4;
+}
+
+void UploadScheduler::SwapFrames(ChromiumSource* frame, ChromiumSource* other) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Hold both frames so neither can be drawn or copied while they trade places
+    pthread_mutex_lock(&frame->texture_mutex);
+    pthread_mutex_lock(&other->texture_mutex);
+    
+    std::swap(frame->texture, other->texture);
+    frame->upload_buffer.swap(other->upload_buffer);
+    std::swap(frame->upload_width, other->upload_width);
+    std::swap(frame->upload_height, other->upload_height);
+    {
+        // A paint of the old page still waiting for upload must not land
+        // on top of the new one
+        std::scoped_lock staging_lock(frame->staging_mutex, other->staging_mutex);
+        frame->staging.swap(other->staging);
+        std::swap(frame->staging_width, other->staging_width);
+        std::swap(frame->staging_height, other->staging_height);
+        std::swap(frame->staging_dirty, other->staging_dirty);
+    }
+    
+    pthread_mutex_unlock(&other->texture_mutex);
+    pthread_mutex_unlock(&frame->texture_mutex);
+}
+
+uint64_t UploadScheduler::ReleaseFrame(ChromiumSource* frame, std::vector<uint8_t>& bgra, int& width, int& height) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t released = 0;
+    {
+        std::lock_guard<std::mutex> staging_lock(frame->staging_mutex);
+        if (frame->staging_dirty) {
+            bgra.swap(frame->staging);
+            width = frame->staging_width;
+            height = frame->staging_height;
+            frame->staging_dirty = false;
+        } else {
+            bgra.swap(frame->upload_buffer);
+            width = frame->upload_width;
+            height = frame->upload_height;
+        }
+        released = bgra.capacity() + frame->staging.capacity() + frame->upload_buffer.capacity();
+        std::vector<uint8_t>().swap(frame->staging);
+        std::vector<uint8_t>().swap(frame->upload_buffer);
+    }
+    
+    // Same lock order as the upload pass
+    obs_enter_graphics();
+    pthread_mutex_lock(&frame->texture_mutex);
+    if (frame->texture) {
+        released += (uint64_t)gs_texture_get_width(frame->texture) * gs_texture_get_height(frame->texture) * 4;
+        TexturePool::GetInstance()->Release(frame->texture);
+        frame->texture = nullptr;
+    }
+    frame->upload_width = 0;
+    frame->upload_height = 0;
+    pthread_mutex_unlock(&frame->texture_mutex);
+    obs_leave_graphics();
+    
+    return released;
+}
+
+bool UploadScheduler::RestoreFrame(ChromiumSource* frame, std::vector<uint8_t>& bgra, int width, int height) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool restored = false;
+    
+    // Same lock order as the upload pass
+    obs_enter_graphics();
+    pthread_mutex_lock(&frame->texture_mutex);
+    {
+        // A paint that arrived while released is newer
+        std::lock_guard<std::mutex> staging_lock(frame->staging_mutex);
+        restored = !frame->texture && !frame->staging_dirty;
+    }
+    if (restored) {
+        frame->texture = TexturePool::GetInstance()->Acquire(width, height);
+        restored = frame->texture != nullptr;
+    }
+    if (restored) {
+        TexturePool::Upload(frame->texture, bgra.data(), width, height);
+        frame->upload_width = width;
+        frame->upload_height = height;
+        
+        // Kept like an uploaded paint, e.g. for the snapshot at shutdown
+        frame->upload_buffer.swap(bgra);
+    }
+    pthread_mutex_unlock(&frame->texture_mutex);
+    obs_leave_graphics();
+    
+    return restored;
+}
+
+uint64_t UploadScheduler::GetResidentBytes(ChromiumSource* frame) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> staging_lock(frame->staging_mutex);
+    return frame->staging.capacity() + frame->upload_buffer.capacity() +
+           (uint64_t)frame->upload_width * frame->upload_height * 4;
+}
+
+UploadStats UploadScheduler::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void UploadScheduler::LogStats() const {
+    UploadStats stats = GetStats();
+    
+    blog(LOG_INFO, "[Upload Scheduler] frames: %llu, uploads: %llu (%.1f MB), deferred: %llu, "
+         "coalesced: %llu, over budget: %llu (%.1f%% of frames)",
+         (unsigned long long)stats.frames, (unsigned long long)stats.uploads,
+         stats.uploaded_bytes / (1024.0 * 1024.0), (unsigned long long)stats.deferred,
+         (unsigned long long)stats.coalesced, (unsigned long long)stats.over_budget,
+         stats.frames ? 100.0 * stats.over_budget / stats.frames : 0.0);
+}
+
+void UploadScheduler::Tick(void* param, float seconds) {
+    UNUSED_PARAMETER(seconds);
+    profile_start(upload_pass_name);
+    static_cast<UploadScheduler*>(param)->RunPass();
+    profile_end(upload_pass_name);
+    
+    TexturePool::GetInstance()->Trim(os_gettime_ns());
+}
+
+void UploadScheduler::RunPass() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stats_.frames++;
+    uint64_t now_ns = os_gettime_ns();
+    
+    struct Candidate {
+        ChromiumSource* frame;
+        uint64_t score;
+        size_t bytes;
+    };
+    
+    // Collect dirty frames and rank them by visibility plus accumulated deferrals
+    std::vector<Candidate> candidates;
+    uint64_t dirty_bytes = 0;
+    for (ChromiumSource* frame : frames_) {
+        int visible = frame->visibility.exchange(0);
+        
+        std::lock_guard<std::mutex> staging_lock(frame->staging_mutex);
+        stats_.coalesced += frame->coalesced_paints;
+        frame->coalesced_paints = 0;
+        if (!frame->staging_dirty) {
+            continue;
+        }
+        
+        uint64_t tier = (visible & UPLOAD_VISIBLE_PROGRAM) ? 2 : (visible & UPLOAD_VISIBLE_PREVIEW) ? 1 : 0;
+        
+        // A playing alert is what the viewer is waiting for
+        if (visible && frame->alerts.IsActive(now_ns)) {
+            tier = 2;
+        }
+        size_t bytes = frame->staging.size();
+        candidates.push_back({frame, tier * UPLOAD_AGING_FRAMES + frame->deferred_uploads, bytes});
+        dirty_bytes += bytes;
+    }
+    
+    if (candidates.empty()) {
+        return;
+    }
+    
+    if (dirty_bytes > budget_bytes_) {
+        stats_.over_budget++;
+    }
+    
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+    
+    uint64_t spent = 0;
+    obs_enter_graphics();
+    
+    for (const Candidate& candidate : candidates) {
+        ChromiumSource* frame = candidate.frame;
+        
+        // The top-ranked frame always goes, even if it alone exceeds the budget
+        if (spent && spent + candidate.bytes > budget_bytes_) {
+            frame->deferred_uploads++;
+            stats_.deferred++;
+            continue;
+        }
+        
+        // Take the newest paint; CEF can keep staging while we upload
+        int width, height;
+        {
+            std::lock_guard<std::mutex> staging_lock(frame->staging_mutex);
+            frame->staging.swap(frame->upload_buffer);
+            width = frame->staging_width;
+            height = frame->staging_height;
+            frame->staging_dirty = false;
+        }
+        frame->deferred_uploads = 0;
+        
+        pthread_mutex_lock(&frame->texture_mutex);
+        
+        // Keep the texture while the paint fits, otherwise trade it for one
+        // that does; the pool keeps the old one in case the size comes back
+        if (!TexturePool::Fits(frame->texture, width, height)) {
+            TexturePool* pool = TexturePool::GetInstance();
+            pool->Release(frame->texture);
+            frame->texture = pool->Acquire(width, height);
+            if (!frame->texture) {
+                blog(LOG_ERROR, "[Upload Scheduler] Failed to create texture (%dx%d)", width, height);
+            }
+        }
+        
+        if (frame->texture) {
+            // CEF provides BGRA data, which matches OBS expectations
+            TexturePool::Upload(frame->texture, frame->upload_buffer.data(), width, height);
+            frame->upload_width = width;
+            frame->upload_height = height;
+            
+            if (frame->page_loaded) {
+                frame->painted_since_load = true;
+            }
+        }
+        
+        pthread_mutex_unlock(&frame->texture_mutex);
+        
+        spent += candidate.bytes;
+        stats_.uploads++;
+        stats_.uploaded_bytes += candidate.bytes;
+    }
+    
+    obs_leave_graphics();
+    
+    if (now_ns - last_log_ns_ >= UPLOAD_LOG_INTERVAL_NS) {
+        last_log_ns_ = now_ns;
+        lock.unlock();
+        LogStats();
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <obs-module.h>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <cstdint>
+
+// Forward declarations
+struct ChromiumSource;
+
+/**
+ * Counters describing how the upload budget is being spent.
+ */
+struct UploadStats {
+    uint64_t frames;           // scheduler passes
+    uint64_t uploads;
+    uint64_t uploaded_bytes;
+    uint64_t deferred;         // dirty frames pushed to a later pass
+    uint64_t coalesced;        // paints replaced by a newer one before upload
+    uint64_t over_budget;      // passes with more dirty bytes than budget
+    
+    UploadStats()
+        : frames(0)
+        , uploads(0)
+        , uploaded_bytes(0)
+        , deferred(0)
+        , coalesced(0)
+        , over_budget(0) {
+    }
+};
+
+/**
+ * Plugin-wide scheduler for texture uploads. CEF paints only copy into a
+ * frame's CPU staging buffer; once per OBS frame the scheduler uploads the
+ * dirty frames within a byte budget. Frames on program go first, then
+ * preview-only, then hidden ones, with frames that keep getting deferred
+ * aging upward so nothing starves. A frame painted again before it is
+ * uploaded only uploads its newest paint.
+ */
+class UploadScheduler {
+public:
+    /**
+     * Get the singleton instance of the scheduler.
+     */
+    static UploadScheduler* GetInstance();
+    
+    /**
+     * Install the per-frame tick callback.
+     */
+    void Start();
+    
+    /**
+     * Remove the tick callback and log the final statistics.
+     */
+    void Stop();
+    
+    /**
+     * Add a frame to the upload rotation.
+     */
+    void Register(ChromiumSource* frame);
+    
+    /**
+     * Remove a frame. Blocks while an upload pass is running.
+     */
+    void Unregister(ChromiumSource* frame);
+    
+    /**
+     * Copy a paint into the frame's staging buffer. Called on CEF threads.
+     */
+    static void StagePaint(ChromiumSource* frame, const void* buffer, int width, int height);
+    
+    /**
+     * Copy the newest paint of a frame, staged or already uploaded. Waits
+     * for a running upload pass.
+     * @return false if the frame has not painted yet
+     */
+    bool CopyLastFrame(ChromiumSource* frame, std::vector<uint8_t>& bgra, int& width, int& height);
+    
+    /**
+     * Trade textures, upload buffers and staged paints between two frames,
+     * e.g. to swap in a reloaded page. Waits for a running upload pass.
+     */
+    void SwapFrames(ChromiumSource* frame, ChromiumSource* other);
+    
+    /**
+     * Give the frame's texture back to the TexturePool and free its
+     * buffers, moving the newest paint out first. Waits for a running
+     * upload pass.
+     * @return bytes of GPU and CPU memory released
+     */
+    uint64_t ReleaseFrame(ChromiumSource* frame, std::vector<uint8_t>& bgra, int& width, int& height);
+    
+    /**
+     * Upload a paint straight into a released frame's texture, so it is
+     * drawn by the very next render instead of after the next upload pass.
+     * Does nothing if the frame has a texture or a staged paint already.
+     * Waits for a running upload pass.
+     * @return false if the paint was not used
+     */
+    bool RestoreFrame(ChromiumSource* frame, std::vector<uint8_t>& bgra, int width, int height);
+    
+    /**
+     * Bytes the frame holds in its texture and buffers.
+     */
+    uint64_t GetResidentBytes(ChromiumSource* frame) const;
+    
+    /**
+     * Get a snapshot of the counters.
+     */
+    UploadStats GetStats() const;
+    
+    /**
+     * Write the counters to the OBS log.
+     */
+    void LogStats() const;
+    
+private:
+    UploadScheduler();
+    
+    mutable std::mutex mutex_;
+    std::set<ChromiumSource*> frames_;
+    bool started_;
+    uint64_t budget_bytes_;
+    uint64_t last_log_ns_;
+    UploadStats stats_;
+    
+    static void Tick(void* param, float seconds);
+    void RunPass();
+};
+
+/**
+ * Visibility bits sources report on their frame every tick.
+ */
+#define UPLOAD_VISIBLE_PREVIEW 1
+#define UPLOAD_VISIBLE_PROGRAM 2
+
+/**
+ * Scheduling parameters.
+ */
+#define UPLOAD_AGING_FRAMES 30                      // deferrals worth one priority tier
+#define UPLOAD_LOG_INTERVAL_NS 300000000000ULL      // 5 minutes